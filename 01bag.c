@@ -2,234 +2,626 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
+#ifdef _WIN32
 #include <direct.h> // Windows 下获取当前目录
+#else
+#include <unistd.h>
+#define _getcwd getcwd
+#endif
+#include "knapsack.h"
 
-// 物品结构体
-typedef struct {
-    int id;        // 物品编号
-    double weight; // 物品重量
-    double value;  // 物品价值
-} Item;
+KnapsackInstanceClass gen_class = KS_GEN_UNCORRELATED; // 生成的实例类型，bench --class 或菜单 23 设置
+unsigned gen_seed = 0; // 下一次生成使用的种子，每生成一次加 1；需要固定数据时先赋值
 
-// 生成随机物品数据
+// 生成随机物品数据（默认不相关：重量 1.00~100.00，价值 100.00~1000.00），大规模时多线程生成
 void generate_items(Item* items, int n) {
-    for (int i = 0; i < n; i++) {
-        items[i].id = i + 1;
-        // 生成1.00~100.00的浮点型重量
-        items[i].weight = ((rand() % 9901) / 100.0) + 1.0; // 1.00~100.00
-        // 生成100.00~1000.00的浮点型价值
-        items[i].value = ((rand() % 90001) / 100.0) + 100.0; // 100.00~1000.00
-    }
+    knapsack_generate(items, n, gen_class, gen_seed++, 0);
 }
 
-// 蛮力法
-void brute_force(Item* items, int n, double capacity, int* selected, double* max_value) {
-    int best_combo = 0;
-    double best_value = 0;
-    for (int i = 0; i < (1 << n); i++) {
-        double total_weight = 0, total_value = 0;
-        for (int j = 0; j < n; j++) {
-            if (i & (1 << j)) {
-                total_weight += items[j].weight;
-                total_value += items[j].value;
-            }
-        }
-        if (total_weight <= capacity && total_value > best_value) {
-            best_value = total_value;
-            best_combo = i;
-        }
+// 按名称查找实例类型，找不到返回 -1
+int find_gen_class(const char* name) {
+    for (int c = 0; c < KS_GEN_CLASS_COUNT; c++) {
+        if (strcmp(knapsack_gen_class_name((KnapsackInstanceClass)c), name) == 0) return c;
     }
-    *max_value = best_value;
-    for (int j = 0; j < n; j++) {
-        selected[j] = (best_combo & (1 << j)) ? 1 : 0;
+    return -1;
+}
+
+// 库函数不输出提示，求解后按 knapsack_last_status 在这里提示；algo 为菜单编号，用于截断时说明上限
+void print_status(int algo) {
+    int status = knapsack_last_status;
+    if (status == KS_STATUS_TRUNCATED && (algo == 14 || algo == 15)) {
+        int limit = algo == 14 ? MITM_MAX_ITEMS : BF_GRAY_MAX_ITEMS;
+        printf("警告：%s最多支持 %d 个物品，只使用前 %d 个！\n", algo == 14 ? "折半搜索" : "格雷码蛮力法", limit, limit);
+    } else if (status != KS_STATUS_OK) {
+        printf("%s\n", knapsack_status_message(status));
     }
 }
 
-// 回溯法
-void backtrack(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
-               double* max_value, int* curr_selected, int* best_selected) {
-    if (idx == n) {
-        if (curr_value > *max_value) {
-            *max_value = curr_value;
-            memcpy(best_selected, curr_selected, n * sizeof(int));
+// 输出结果
+void print_result(Item* items, int n, int* selected, double max_value, double time_ms, double capacity) {
+    printf("选择的物品编号、重量、价值：\n");
+    double total_weight = 0;
+    int count = 0;
+    for (int i = 0; i < n && count < 10; i++) { // 限制输出前10个物品，避免过多输出
+        if (selected[i]) {
+            printf("物品 %d: 重量 %.2f, 价值 %.2f\n", items[i].id, items[i].weight, items[i].value);
+            total_weight += items[i].weight;
+            count++;
         }
-        return;
     }
-    // 不选当前物品
-    curr_selected[idx] = 0;
-    backtrack(items, n, capacity, idx + 1, curr_weight, curr_value, max_value, curr_selected, best_selected);
-    // 选当前物品（如果重量允许）
-    if (curr_weight + items[idx].weight <= capacity) {
-        curr_selected[idx] = 1;
-        backtrack(items, n, capacity, idx + 1, curr_weight + items[idx].weight,
-                  curr_value + items[idx].value, max_value, curr_selected, best_selected);
+    if (count < n) printf("（仅显示前10个物品，实际选择可能更多）\n");
+    printf("总重量: %.2f, 总价值: %.2f, 执行时间: %.2f ms\n\n", total_weight, max_value, time_ms);
+}
+
+// 输出CSV的一个字段：负数表示该规模未运行，留空
+void fprint_field(FILE* fp, double x, int digits) {
+    if (x < 0) fprintf(fp, ",");
+    else fprintf(fp, ",%.*f", digits, x);
+}
+
+// 流式读取CSV时累计物品数据
+typedef struct {
+    double weight;
+    double value;
+} CsvTotals;
+
+int csv_totals_sink(const Item* items, int count, void* user) {
+    CsvTotals* totals = (CsvTotals*)user;
+    for (int i = 0; i < count; i++) {
+        totals->weight += items[i].weight;
+        totals->value += items[i].value;
     }
+    return 0;
+}
+
+#define SWEEP_DP_MAX_N 32000    // 模式7中DP与选择排序贪心的最大规模
+#define SWEEP_SPARSE_MAX_N 5000 // 模式7中稀疏DP的最大规模（状态数随规模快速增长）
+
+// ---------------- 基准测试 ----------------
+// 每个 (算法, 规模, 容量) 先预热若干次，再重复计时，输出中位数/最小值/最大值/标准差；
+// 计时用单调时钟（knapsack_now_ns），数据由固定种子生成，同一种子的两次运行使用完全相同的实例
+#define BENCH_DEFAULT_SEED 20240601u
+#define BENCH_WARMUP 1          // 默认预热次数
+#define BENCH_TRIALS 5          // 默认计时次数
+#define BENCH_MAX_TRIALS 1000
+#define BENCH_MIN_TRIALS 3      // 超出时间预算后至少保留的计时次数
+#define BENCH_BUDGET_MS 2000.0  // 单个算法单个规模的计时预算
+
+typedef void (*SolveFn)(Item* items, int n, double capacity, int* selected, double* max_value);
+
+typedef struct {
+    double median_ms;
+    double min_ms;
+    double max_ms;
+    double stddev_ms;
+    int trials;
+    double value; // 最后一次求解得到的价值
+} BenchStats;
+
+unsigned bench_seed = BENCH_DEFAULT_SEED; // 随机种子，命令行 --seed 或交互菜单中设置
+int bench_threads = 0;                    // 多线程算法的线程数，0 表示 cpu_count()
+
+// 规模为 n、第 k 个容量的实例使用的种子：同一种子下每个格点的数据固定，且与格点的运行顺序无关
+unsigned bench_case_seed(int n, int k) {
+    return bench_seed ^ (unsigned)n * 2654435761u ^ (unsigned)k * 40503u;
 }
 
-// 回溯法（剪枝：若当前重量+剩余物品最大价值<=已知最优，则剪枝）
-void backtrack_prune(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
-                     double* max_value, int* curr_selected, int* best_selected, double remain_value) {
-    if (idx == n) {
-        if (curr_value > *max_value) {
-            *max_value = curr_value;
-            memcpy(best_selected, curr_selected, n * sizeof(int));
+static int bench_cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// 对 solve 计时：items 为原始数据，work 不为 NULL 时每次计时前把原始数据复制到 work（用于会重排物品的算法）
+void bench_measure(SolveFn solve, Item* items, Item* work, int n, double capacity, int* selected,
+                   int warmup, int trials, BenchStats* st) {
+    double times[BENCH_MAX_TRIALS];
+    double total_ms = 0;
+    if (trials > BENCH_MAX_TRIALS) trials = BENCH_MAX_TRIALS;
+    if (trials < 1) trials = 1;
+    int done = 0;
+    int status = KS_STATUS_OK;
+    for (int r = -warmup; r < trials; r++) {
+        Item* data = items;
+        if (work) {
+            memcpy(work, items, n * sizeof(Item));
+            data = work;
         }
-        return;
+        memset(selected, 0, n * sizeof(int));
+        double max_value = 0;
+        knapsack_last_status = KS_STATUS_OK;
+        uint64_t start = knapsack_now_ns();
+        solve(data, n, capacity, selected, &max_value);
+        double ms = (knapsack_now_ns() - start) / 1e6;
+        if (knapsack_last_status != KS_STATUS_OK) status = knapsack_last_status;
+        st->value = max_value;
+        if (r < 0) continue; // 预热，不计入结果
+        times[done++] = ms;
+        total_ms += ms;
+        if (done >= BENCH_MIN_TRIALS && total_ms > BENCH_BUDGET_MS) break;
     }
-    // 剪枝：如果当前价值+剩余最大价值<=已知最优，则不再递归
-    if (curr_value + remain_value <= *max_value) return;
-
-    // 不选当前物品
-    curr_selected[idx] = 0;
-    backtrack_prune(items, n, capacity, idx + 1, curr_weight, curr_value, max_value, curr_selected, best_selected, remain_value - items[idx].value);
-
-    // 选当前物品（如果重量允许）
-    if (curr_weight + items[idx].weight <= capacity) {
-        curr_selected[idx] = 1;
-        backtrack_prune(items, n, capacity, idx + 1, curr_weight + items[idx].weight,
-                        curr_value + items[idx].value, max_value, curr_selected, best_selected, remain_value - items[idx].value);
+    qsort(times, done, sizeof(double), bench_cmp_double);
+    double mean = total_ms / done, var = 0;
+    for (int i = 0; i < done; i++) var += (times[i] - mean) * (times[i] - mean);
+    st->median_ms = done % 2 ? times[done / 2] : (times[done / 2 - 1] + times[done / 2]) / 2;
+    st->min_ms = times[0];
+    st->max_ms = times[done - 1];
+    st->stddev_ms = done > 1 ? sqrt(var / (done - 1)) : 0;
+    st->trials = done;
+    knapsack_last_status = status;
+    if (status != KS_STATUS_OK) print_status(0);
+}
+
+// 统一签名的包装，便于放进算法表
+void bench_backtrack(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int* curr_selected = (int*)calloc(n > 0 ? n : 1, sizeof(int));
+    *max_value = 0;
+    backtrack(items, n, capacity, 0, 0, 0, max_value, curr_selected, selected);
+    free(curr_selected);
+}
+
+void bench_backtrack_prune(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int* curr_selected = (int*)calloc(n > 0 ? n : 1, sizeof(int));
+    double remain_value = 0;
+    for (int i = 0; i < n; i++) remain_value += items[i].value;
+    *max_value = 0;
+    backtrack_prune(items, n, capacity, 0, 0, 0, max_value, curr_selected, selected, remain_value);
+    free(curr_selected);
+}
+
+void bench_backtrack_iterative(Item* items, int n, double capacity, int* selected, double* max_value) {
+    backtrack_iterative(items, n, capacity, selected, max_value, 0);
+}
+
+void bench_backtrack_iterative_prune(Item* items, int n, double capacity, int* selected, double* max_value) {
+    backtrack_iterative(items, n, capacity, selected, max_value, 1);
+}
+
+void bench_brute_force_gray(Item* items, int n, double capacity, int* selected, double* max_value) {
+    brute_force_gray(items, n, capacity, selected, max_value, bench_threads > 0 ? bench_threads : cpu_count());
+}
+
+void bench_dp_parallel(Item* items, int n, double capacity, int* selected, double* max_value) {
+    dynamic_programming_parallel(items, n, capacity, selected, max_value, bench_threads > 0 ? bench_threads : cpu_count());
+}
+
+void bench_bb_dfs(Item* items, int n, double capacity, int* selected, double* max_value) {
+    branch_and_bound(items, n, capacity, selected, max_value, 0);
+}
+
+void bench_bb_best_first(Item* items, int n, double capacity, int* selected, double* max_value) {
+    branch_and_bound(items, n, capacity, selected, max_value, 1);
+}
+
+typedef struct {
+    const char* key;  // 命令行中的名字
+    const char* name; // 输出中的名字
+    SolveFn solve;
+    int mutates;      // 是否会重排物品数组
+    int max_n;        // 超过该规模不运行，0 表示不限
+} BenchSolver;
+
+const BenchSolver bench_solvers[] = {
+    {"brute", "蛮力法", brute_force, 0, 24},
+    {"gray", "格雷码并行蛮力", bench_brute_force_gray, 0, 32},
+    {"backtrack", "回溯法", bench_backtrack, 0, 26},
+    {"prune", "回溯剪枝", bench_backtrack_prune, 0, 30},
+    {"iter", "迭代回溯", bench_backtrack_iterative, 0, 26},
+    {"iter_prune", "迭代剪枝", bench_backtrack_iterative_prune, 0, 30},
+    {"mitm", "折半搜索", meet_in_middle, 0, 50},
+    {"dp", "动态规划", dynamic_programming, 0, SWEEP_DP_MAX_N},
+    {"rolling", "滚动DP", dynamic_programming_rolling, 0, 0},
+    {"dp_int", "整数DP", dynamic_programming_int, 0, 0},
+    {"parallel", "多线程DP", bench_dp_parallel, 0, 0},
+    {"sparse", "稀疏DP", sparse_dp, 0, SWEEP_SPARSE_MAX_N},
+    {"greedy", "快排贪心", greedy, 1, 0},
+    {"selection", "选择排序贪心", greedy_selection, 0, SWEEP_DP_MAX_N},
+    {"greedy_fast", "快速选择贪心", greedy_fast, 0, 0},
+    {"core", "核心算法", core_solver, 0, 0},
+    {"bb", "分支限界（深度优先）", bench_bb_dfs, 0, 0},
+    {"bb_best", "分支限界（最佳优先）", bench_bb_best_first, 0, 0},
+};
+const int bench_solver_count = sizeof(bench_solvers) / sizeof(bench_solvers[0]);
+
+const BenchSolver* bench_find_solver(const char* key) {
+    for (int i = 0; i < bench_solver_count; i++) {
+        if (strcmp(bench_solvers[i].key, key) == 0) return &bench_solvers[i];
     }
+    return NULL;
 }
 
-// 动态规划法（整数化处理）
-void dynamic_programming(Item* items, int n, double capacity, int* selected, double* max_value) {
-    int scale = 100; // 精度：保留两位小数
-    int int_capacity = (int)(capacity * scale + 0.5);
-    int* int_weight = (int*)malloc(n * sizeof(int));
-    double* value = (double*)malloc(n * sizeof(double));
-    for (int i = 0; i < n; i++) {
-        int_weight[i] = (int)(items[i].weight * scale + 0.5);
-        value[i] = items[i].value;
+#define BENCH_MAX_GRID 64
+
+typedef struct {
+    int sizes[BENCH_MAX_GRID];
+    int size_count;
+    double capacities[BENCH_MAX_GRID];
+    int capacity_count;
+    const BenchSolver* solvers[BENCH_MAX_GRID];
+    int solver_count;
+    int warmup;
+    int trials;
+    const char* csv_path;  // 为 NULL 时不输出
+    const char* json_path;
+    int perf;              // 非 0 时另外跑一轮带硬件计数器的求解，按阶段输出计数
+} BenchConfig;
+
+// 解析逗号分隔的列表，返回个数
+int bench_parse_ints(const char* s, int* out, int max_count) {
+    int count = 0;
+    while (*s && count < max_count) {
+        char* end;
+        long x = strtol(s, &end, 10);
+        if (end == s) break;
+        out[count++] = (int)x;
+        s = *end == ',' ? end + 1 : end;
     }
+    return count;
+}
 
-    double** dp = (double**)malloc((n + 1) * sizeof(double*));
-    int** keep = (int**)malloc((n + 1) * sizeof(int*));
-    for (int i = 0; i <= n; i++) {
-        dp[i] = (double*)calloc(int_capacity + 1, sizeof(double));
-        keep[i] = (int*)calloc(int_capacity + 1, sizeof(int));
+int bench_parse_doubles(const char* s, double* out, int max_count) {
+    int count = 0;
+    while (*s && count < max_count) {
+        char* end;
+        double x = strtod(s, &end);
+        if (end == s) break;
+        out[count++] = x;
+        s = *end == ',' ? end + 1 : end;
     }
+    return count;
+}
 
-    for (int i = 1; i <= n; i++) {
-        for (int w = 0; w <= int_capacity; w++) {
-            if (int_weight[i-1] <= w) {
-                double val_without = dp[i-1][w];
-                double val_with = dp[i-1][w - int_weight[i-1]] + value[i-1];
-                if (val_with > val_without) {
-                    dp[i][w] = val_with;
-                    keep[i][w] = 1;
-                } else {
-                    dp[i][w] = val_without;
-                }
-            } else {
-                dp[i][w] = dp[i-1][w];
-            }
+int bench_parse_solvers(const char* s, const BenchSolver** out, int max_count) {
+    char buf[512];
+    int count = 0;
+    strncpy(buf, s, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (char* tok = strtok(buf, ","); tok && count < max_count; tok = strtok(NULL, ",")) {
+        const BenchSolver* solver = bench_find_solver(tok);
+        if (!solver) {
+            fprintf(stderr, "未知算法: %s\n", tok);
+            return -1;
         }
+        out[count++] = solver;
     }
+    return count;
+}
 
-    *max_value = dp[n][int_capacity];
-    int w = int_capacity;
-    for (int i = n; i > 0; i--) {
-        if (keep[i][w]) {
-            selected[i-1] = 1;
-            w -= int_weight[i-1];
+// 带计数器再跑 runs 次（与计时分开，避免读计数器的系统调用混进计时），各阶段累计值留在 knapsack_perf_read 中
+void bench_perf_run(SolveFn solve, Item* items, Item* work, int n, double capacity, int* selected, int runs) {
+    knapsack_perf_reset();
+    for (int r = 0; r < runs; r++) {
+        Item* data = items;
+        if (work) {
+            memcpy(work, items, n * sizeof(Item));
+            data = work;
         }
+        memset(selected, 0, n * sizeof(int));
+        double max_value = 0;
+        solve(data, n, capacity, selected, &max_value);
     }
+}
 
-    for (int i = 0; i <= n; i++) {
-        free(dp[i]);
-        free(keep[i]);
+// 计数值按每次求解的平均值输出；计数器不可用或算法没有该阶段时留空（JSON 中为 null）
+void bench_perf_csv(FILE* csv) {
+    for (int p = 0; p < KS_PHASE_COUNT; p++) {
+        KnapsackPerfCounters pc;
+        knapsack_perf_read((KnapsackPhase)p, &pc);
+        long long fields[4] = {pc.cycles, pc.instructions, pc.cache_misses, pc.branch_misses};
+        for (int k = 0; k < 4; k++) {
+            if (pc.calls > 0 && fields[k] >= 0) fprintf(csv, ",%lld", fields[k] / pc.calls);
+            else fprintf(csv, ",");
+        }
+        if (pc.calls > 0) fprintf(csv, ",%.6f", pc.ns / 1e6 / pc.calls);
+        else fprintf(csv, ",");
     }
-    free(dp);
-    free(keep);
-    free(int_weight);
-    free(value);
 }
 
-// 比较函数：按价值/重量比降序排序
-int cmp(const void* a, const void* b) {
-    double ratio_a = ((Item*)a)->value / ((Item*)a)->weight;
-    double ratio_b = ((Item*)b)->value / ((Item*)b)->weight;
-    return ratio_a < ratio_b ? 1 : -1;
+void bench_perf_json(FILE* json) {
+    static const char* keys[4] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+    int first = 1;
+    fprintf(json, ", \"perf\": {");
+    for (int p = 0; p < KS_PHASE_COUNT; p++) {
+        KnapsackPerfCounters pc;
+        knapsack_perf_read((KnapsackPhase)p, &pc);
+        if (pc.calls == 0) continue;
+        long long fields[4] = {pc.cycles, pc.instructions, pc.cache_misses, pc.branch_misses};
+        fprintf(json, "%s\"%s\": {", first ? "" : ", ", knapsack_perf_phase_name((KnapsackPhase)p));
+        for (int k = 0; k < 4; k++) {
+            if (fields[k] >= 0) fprintf(json, "\"%s\": %lld, ", keys[k], fields[k] / pc.calls);
+            else fprintf(json, "\"%s\": null, ", keys[k]);
+        }
+        fprintf(json, "\"ms\": %.6f}", pc.ns / 1e6 / pc.calls);
+        first = 0;
+    }
+    fprintf(json, "}");
 }
 
-// 选择排序实现（按价值/重量比降序）
-void selection_sort(Item* items, int n) {
-    for (int i = 0; i < n - 1; i++) {
-        int max_idx = i;
-        double max_ratio = items[i].value / items[i].weight;
-        for (int j = i + 1; j < n; j++) {
-            double ratio = items[j].value / items[j].weight;
-            if (ratio > max_ratio) {
-                max_ratio = ratio;
-                max_idx = j;
-            }
+// 按网格运行：每行输出一个 (算法, 规模, 容量) 的统计；CSV 与 JSON 字段相同
+int bench_run(const BenchConfig* cfg) {
+    FILE* csv = cfg->csv_path ? fopen(cfg->csv_path, "w") : NULL;
+    FILE* json = cfg->json_path ? fopen(cfg->json_path, "w") : NULL;
+    if ((cfg->csv_path && !csv) || (cfg->json_path && !json)) {
+        printf("无法创建输出文件！\n");
+        if (csv) fclose(csv);
+        if (json) fclose(json);
+        return -1;
+    }
+    if (csv) {
+        fprintf(csv, "算法,物品数,容量,中位数(ms),最小值(ms),最大值(ms),标准差(ms),计时次数,价值");
+        for (int p = 0; cfg->perf && p < KS_PHASE_COUNT; p++) {
+            const char* phase = knapsack_perf_phase_name((KnapsackPhase)p);
+            fprintf(csv, ",%s_周期,%s_指令,%s_缓存未命中,%s_分支未命中,%s_耗时(ms)", phase, phase, phase, phase, phase);
         }
-        if (max_idx != i) {
-            Item tmp = items[i];
-            items[i] = items[max_idx];
-            items[max_idx] = tmp;
+        fprintf(csv, "\n");
+    }
+    if (json) {
+        fprintf(json, "{\n  \"seed\": %u,\n  \"class\": \"%s\",\n  \"warmup\": %d,\n  \"trials\": %d,\n  \"results\": [", bench_seed,
+                knapsack_gen_class_name(gen_class), cfg->warmup, cfg->trials);
+    }
+    int first = 1;
+    for (int k = 0; k < cfg->capacity_count; k++) {
+        double capacity = cfg->capacities[k];
+        for (int s = 0; s < cfg->size_count; s++) {
+            int n = cfg->sizes[s];
+            Item* items = (Item*)malloc((n > 0 ? n : 1) * sizeof(Item));
+            Item* work = (Item*)malloc((n > 0 ? n : 1) * sizeof(Item));
+            int* selected = (int*)calloc(n > 0 ? n : 1, sizeof(int));
+            gen_seed = bench_case_seed(n, k);
+            generate_items(items, n);
+            for (int a = 0; a < cfg->solver_count; a++) {
+                const BenchSolver* solver = cfg->solvers[a];
+                if (solver->max_n > 0 && n > solver->max_n) continue;
+                BenchStats st;
+                bench_measure(solver->solve, items, solver->mutates ? work : NULL, n, capacity, selected,
+                              cfg->warmup, cfg->trials, &st);
+                printf("%-12s n=%-8d 容量=%-10.2f 中位数 %10.4f ms  最小 %10.4f ms  标准差 %8.4f ms（%d 次）\n",
+                       solver->key, n, capacity, st.median_ms, st.min_ms, st.stddev_ms, st.trials);
+                if (cfg->perf) {
+                    bench_perf_run(solver->solve, items, solver->mutates ? work : NULL, n, capacity, selected, st.trials);
+                }
+                if (csv) {
+                    fprintf(csv, "%s,%d,%.2f,%.6f,%.6f,%.6f,%.6f,%d,%.2f", solver->name, n, capacity,
+                            st.median_ms, st.min_ms, st.max_ms, st.stddev_ms, st.trials, st.value);
+                    if (cfg->perf) bench_perf_csv(csv);
+                    fprintf(csv, "\n");
+                }
+                if (json) {
+                    fprintf(json, "%s\n    {\"algo\": \"%s\", \"n\": %d, \"capacity\": %.2f, \"median_ms\": %.6f, \"min_ms\": %.6f, "
+                            "\"max_ms\": %.6f, \"stddev_ms\": %.6f, \"trials\": %d, \"value\": %.2f",
+                            first ? "" : ",", solver->key, n, capacity, st.median_ms, st.min_ms, st.max_ms,
+                            st.stddev_ms, st.trials, st.value);
+                    if (cfg->perf) bench_perf_json(json);
+                    fprintf(json, "}");
+                }
+                first = 0;
+            }
+            free(items);
+            free(work);
+            free(selected);
         }
     }
+    if (json) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    if (csv) fclose(csv);
+    return 0;
 }
 
-// 贪心法
-void greedy(Item* items, int n, double capacity, int* selected, double* max_value) {
-    qsort(items, n, sizeof(Item), cmp);
-    double total_weight = 0;
-    *max_value = 0;
-    for (int i = 0; i < n; i++) {
-        if (total_weight + items[i].weight <= capacity) {
-            selected[i] = 1;
-            total_weight += items[i].weight;
-            *max_value += items[i].value;
-        } else {
-            selected[i] = 0;
+// 命令行：01bag bench [--sizes 100,1000] [--caps 1000,10000] [--algos dp,greedy] [--seed N]
+//                      [--warmup K] [--trials T] [--threads P] [--csv 文件] [--json 文件] [--perf 1] [--class 类型]
+int bench_main(int argc, char** argv) {
+    BenchConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.size_count = bench_parse_ints("100,1000,10000", cfg.sizes, BENCH_MAX_GRID);
+    cfg.capacity_count = bench_parse_doubles("1000", cfg.capacities, BENCH_MAX_GRID);
+    cfg.solver_count = bench_parse_solvers("dp,rolling,greedy,greedy_fast,core", cfg.solvers, BENCH_MAX_GRID);
+    cfg.warmup = BENCH_WARMUP;
+    cfg.trials = BENCH_TRIALS;
+    cfg.csv_path = "result_bench.csv";
+    cfg.json_path = "result_bench.json";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const char* opt = argv[i];
+        const char* val = argv[i + 1];
+        if (strcmp(opt, "--sizes") == 0) cfg.size_count = bench_parse_ints(val, cfg.sizes, BENCH_MAX_GRID);
+        else if (strcmp(opt, "--caps") == 0) cfg.capacity_count = bench_parse_doubles(val, cfg.capacities, BENCH_MAX_GRID);
+        else if (strcmp(opt, "--algos") == 0) cfg.solver_count = bench_parse_solvers(val, cfg.solvers, BENCH_MAX_GRID);
+        else if (strcmp(opt, "--seed") == 0) bench_seed = (unsigned)strtoul(val, NULL, 10);
+        else if (strcmp(opt, "--warmup") == 0) cfg.warmup = atoi(val);
+        else if (strcmp(opt, "--trials") == 0) cfg.trials = atoi(val);
+        else if (strcmp(opt, "--threads") == 0) bench_threads = atoi(val);
+        else if (strcmp(opt, "--csv") == 0) cfg.csv_path = val;
+        else if (strcmp(opt, "--json") == 0) cfg.json_path = val;
+        else if (strcmp(opt, "--perf") == 0) cfg.perf = atoi(val);
+        else if (strcmp(opt, "--class") == 0) {
+            int cls = find_gen_class(val);
+            if (cls < 0) {
+                fprintf(stderr, "未知实例类型: %s\n", val);
+                return 1;
+            }
+            gen_class = (KnapsackInstanceClass)cls;
         }
+        else {
+            fprintf(stderr, "未知选项: %s\n", opt);
+            return 1;
+        }
+    }
+    if (cfg.solver_count < 0) return 1;
+    printf("随机种子: %u，实例类型: %s，预热 %d 次，计时 %d 次\n", bench_seed, knapsack_gen_class_name(gen_class),
+           cfg.warmup, cfg.trials);
+    if (cfg.perf) {
+        int counters = knapsack_perf_enable(1);
+        if (counters > 0) printf("硬件计数器: 已打开 %d 个，按阶段输出每次求解的平均值\n", counters);
+        else printf("硬件计数器不可用（内核不支持或 perf_event_paranoid 限制），只输出各阶段耗时\n");
     }
+    if (bench_run(&cfg) != 0) return 1;
+    printf("已生成 %s 与 %s 文件。\n", cfg.csv_path, cfg.json_path);
+    return 0;
 }
 
-// 贪心法（选择排序版）
-void greedy_selection(Item* items, int n, double capacity, int* selected, double* max_value) {
-    // 复制一份数据，避免影响原数组
-    Item* items_copy = (Item*)malloc(n * sizeof(Item));
-    memcpy(items_copy, items, n * sizeof(Item));
-    selection_sort(items_copy, n);
-    double total_weight = 0;
-    *max_value = 0;
-    for (int i = 0; i < n; i++) {
-        if (total_weight + items_copy[i].weight <= capacity) {
-            selected[i] = 1;
-            total_weight += items_copy[i].weight;
-            *max_value += items_copy[i].value;
-        } else {
-            selected[i] = 0;
+
+// 批量模式：01bag batch [线程数] < 实例文件 > 结果文件，统计信息输出到 stderr
+int batch_main(int threads) {
+    KnapsackBatchStats stats;
+    int status = knapsack_batch_solve(stdin, stdout, threads, &stats);
+    if (status < 0) {
+        fprintf(stderr, "内存不足，无法启动批量求解！\n");
+        return 1;
+    }
+    if (status > 0) {
+        fprintf(stderr, "第 %lld 个实例格式错误、不完整或内存不足，已停止读取！\n", stats.instances + 1);
+    }
+    fprintf(stderr, "实例数: %lld（失败 %lld），耗时: %.3f s，吞吐: %.0f 个/秒\n",
+            stats.instances, stats.failed, stats.seconds, stats.per_second);
+    fprintf(stderr, "单实例延迟 p50: %.2f us，p99: %.2f us，在途上限: %d 个\n", stats.p50_us, stats.p99_us, stats.in_flight);
+    return status;
+}
+
+// 自检：01bag selftest 或菜单 29，逐项打印“通过/失败”，有失败项时返回非零
+int selftest_failed = 0;
+
+void selftest_check(const char* name, int ok) {
+    printf("%s：%s\n", name, ok ? "通过" : "失败");
+    if (!ok) selftest_failed++;
+}
+
+// 恰好装满：0.10 + 0.20 按 double 相加大于 0.30，容量判断若累加浮点重量就会错过最优解 3.00
+void selftest_exact_fit(void) {
+    Item items[3] = {{1, 0.10, 1.00}, {2, 0.20, 2.00}, {3, 0.30, 2.90}};
+    int selected[3];
+    double max_value;
+    memset(selected, 0, sizeof(selected));
+    branch_and_bound(items, 3, 0.30, selected, &max_value, 0);
+    selftest_check("分支限界（深度优先）恰好装满", fabs(max_value - 3.00) < 1e-9 && selected[0] && selected[1]);
+    memset(selected, 0, sizeof(selected));
+    branch_and_bound(items, 3, 0.30, selected, &max_value, 1);
+    selftest_check("分支限界（最佳优先）恰好装满", fabs(max_value - 3.00) < 1e-9 && selected[0] && selected[1]);
+
+    // 不是两位小数的重量：0.125 按 ×100 取整为 13，两个合计 26 超过容量 25（0.25），只能选一个；
+    // 按 double 判断容量的贪心初始解会两个都选
+    Item odd[2] = {{1, 0.125, 1.00}, {2, 0.125, 1.00}};
+    for (int best_first = 0; best_first <= 1; best_first++) {
+        memset(selected, 0, sizeof(selected));
+        branch_and_bound(odd, 2, 0.25, selected, &max_value, best_first);
+        selftest_check(best_first ? "分支限界（最佳优先）初始解按整数重量可行" : "分支限界（深度优先）初始解按整数重量可行",
+                       fabs(max_value - 1.00) < 1e-9 && selected[0] + selected[1] == 1);
+    }
+    memset(selected, 0, sizeof(selected));
+    sparse_dp(items, 3, 0.30, selected, &max_value);
+    selftest_check("稀疏DP恰好装满", fabs(max_value - 3.00) < 1e-9 && selected[0] && selected[1]);
+
+    // 随机实例：容量取随机子集的重量和，与整数DP对比
+    int bad = 0, bad_sparse = 0;
+    unsigned saved_seed = gen_seed;
+    KnapsackInstanceClass saved_class = gen_class;
+    for (int t = 0; t < 200; t++) {
+        int n = 5 + t % 20;
+        Item* rnd = (Item*)malloc(n * sizeof(Item));
+        int* sel = (int*)calloc(n, sizeof(int));
+        gen_class = (KnapsackInstanceClass)(t % KS_GEN_CLASS_COUNT);
+        gen_seed = t;
+        generate_items(rnd, n);
+        long long cap100 = 0;
+        for (int i = 0; i < n; i++) {
+            if ((i * 7 + t) % 3 != 0) cap100 += (long long)(rnd[i].weight * 100 + 0.5);
         }
+        double capacity = cap100 / 100.0;
+        double exact, dfs, best_first;
+        dynamic_programming_int(rnd, n, capacity, sel, &exact);
+        branch_and_bound(rnd, n, capacity, sel, &dfs, 0);
+        branch_and_bound(rnd, n, capacity, sel, &best_first, 1);
+        if (fabs(dfs - exact) > 0.005 || fabs(best_first - exact) > 0.005) bad++;
+        double sparse;
+        sparse_dp(rnd, n, capacity, sel, &sparse);
+        if (fabs(sparse - exact) > 0.005) bad_sparse++;
+        free(rnd);
+        free(sel);
     }
-    free(items_copy);
+    gen_seed = saved_seed;
+    gen_class = saved_class;
+    selftest_check("分支限界随机恰好装满（200 例，与整数DP对比）", bad == 0);
+    selftest_check("稀疏DP随机恰好装满（200 例，与整数DP对比）", bad_sparse == 0);
 }
 
-// 输出结果
-void print_result(Item* items, int n, int* selected, double max_value, double time_ms, double capacity) {
-    printf("选择的物品编号、重量、价值：\n");
-    double total_weight = 0;
-    int count = 0;
-    for (int i = 0; i < n && count < 10; i++) { // 限制输出前10个物品，避免过多输出
-        if (selected[i]) {
-            printf("物品 %d: 重量 %.2f, 价值 %.2f\n", items[i].id, items[i].weight, items[i].value);
-            total_weight += items[i].weight;
-            count++;
+// 损坏的二进制实例文件：改写文件头里的列偏移（编号/重量/价值/整数重量列偏移依次位于第 40/48/56/64 字节），
+// 列超出文件、互相重叠或偏移加长度溢出时都必须拒绝打开
+void selftest_binary_header(void) {
+    const char* path = "selftest.ksb";
+    Item items[100];
+    for (int i = 0; i < 100; i++) {
+        items[i].id = i + 1;
+        items[i].weight = 1 + i % 50;
+        items[i].value = 2 + i % 7;
+    }
+    KnapsackColumns cols;
+    int ok = knapsack_save_binary(path, items, 100, 500.0, KNAPSACK_BIN_INT_WEIGHT) == 0 &&
+             knapsack_open_binary(path, &cols) == 0;
+    if (ok) {
+        ok = cols.n == 100 && cols.weight[99] == items[99].weight && cols.int_weight[99] == 5000;
+        knapsack_close_binary(&cols);
+    }
+    selftest_check("二进制实例文件正常打开", ok);
+
+    struct {
+        const char* name;
+        long pos;
+        uint64_t value;
+    } cases[] = {
+        {"编号列超出文件", 40, (uint64_t)1 << 40},
+        {"重量列超出文件", 48, (uint64_t)1 << 62},
+        {"重量列与编号列重叠", 48, 128},
+        {"价值列偏移加长度溢出", 56, ~(uint64_t)63},
+        {"整数重量列超出文件", 64, (uint64_t)1 << 20},
+    };
+    for (int c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) {
+        FILE* fp = fopen(path, "r+b");
+        uint64_t saved = 0;
+        int rejected = 0;
+        if (fp && fseek(fp, cases[c].pos, SEEK_SET) == 0 && fread(&saved, sizeof(saved), 1, fp) == 1) {
+            fseek(fp, cases[c].pos, SEEK_SET);
+            fwrite(&cases[c].value, sizeof(uint64_t), 1, fp);
+            fflush(fp);
+            rejected = knapsack_open_binary(path, &cols) != 0;
+            if (!rejected) knapsack_close_binary(&cols);
+            fseek(fp, cases[c].pos, SEEK_SET);
+            fwrite(&saved, sizeof(saved), 1, fp);
         }
+        if (fp) fclose(fp);
+        char name[128];
+        snprintf(name, sizeof(name), "损坏的二进制文件头（%s）被拒绝", cases[c].name);
+        selftest_check(name, rejected);
     }
-    if (count < n) printf("（仅显示前10个物品，实际选择可能更多）\n");
-    printf("总重量: %.2f, 总价值: %.2f, 执行时间: %.2f ms\n\n", total_weight, max_value, time_ms);
+    remove(path);
+}
+
+int selftest_main(void) {
+    selftest_failed = 0;
+    selftest_exact_fit();
+    selftest_binary_header();
+    printf("自检完成：%d 项失败\n", selftest_failed);
+    return selftest_failed ? 1 : 0;
 }
 
 // 主函数
-int main() {
-    srand(time(NULL));
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) {
+        return batch_main(argc > 2 ? atoi(argv[2]) : 0);
+    }
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return bench_main(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "selftest") == 0) {
+        return selftest_main();
+    }
+    if (argc > 2 && strcmp(argv[1], "--seed") == 0) {
+        bench_seed = (unsigned)strtoul(argv[2], NULL, 10);
+    }
+    printf("随机种子: %u（可用 --seed 指定，相同种子生成相同数据）\n", bench_seed);
+    gen_seed = bench_seed;
     while (1) {
         int algo;
-        printf("请选择算法：\n1. 蛮力法\n2. 回溯法\n3. 动态规划法\n4. 贪心法\n5. 四种算法一起运行\n6. 小规模四算法对比\n7. 大规模只对比DP和贪心\n0. 退出\n输入编号：");
+        printf("请选择算法：\n1. 蛮力法\n2. 回溯法\n3. 动态规划法\n4. 贪心法\n5. 四种算法一起运行\n6. 小规模四算法对比\n7. 大规模只对比DP和贪心\n8. 滚动数组动态规划（低内存）\n9. 多线程动态规划\n10. 多线程DP扩展性测试\n11. 分支限界法（深度优先）\n12. 分支限界法（最佳优先）\n13. 回溯法（迭代剪枝版）\n14. 折半搜索（40~50个物品的精确解）\n15. 格雷码多线程蛮力法\n16. 贪心法（快速选择版）\n17. 核心算法（大规模精确解）\n18. 稀疏动态规划（支配表）\n19. 从CSV文件读取物品（mmap/流式）\n20. CSV转换为二进制实例文件\n21. 读取二进制实例文件并求解（零拷贝）\n22. 基准测试（自定义规模/容量网格）\n23. 选择实例类型（难例生成器）\n24. 整数定点动态规划（int32/int64）\n25. 增量求解（逐个加入/删除物品）\n26. 多容量查询（一次求解回答多个容量）\n27. 限时求解（给定截止时间，报告最优性差距）\n28. DP缓存分块对比（容量从L1扫到超出末级缓存）\n29. 正确性自检（边界用例）\n0. 退出\n输入编号：");
         scanf("%d", &algo);
 
         if (algo == 0) {
@@ -245,7 +637,10 @@ int main() {
                 printf("警告：数量过大会导致运行极慢甚至崩溃！\n");
                 n = 20;
             }
-        } else if (algo == 3 || algo == 4) {
+        } else if (algo == 13 || algo == 14 || algo == 15) {
+            printf("请输入物品数量（建议40以内）：");
+            scanf("%d", &n);
+        } else if (algo == 3 || algo == 4 || algo == 8 || algo == 9 || algo == 11 || algo == 12 || algo == 16 || algo == 17 || algo == 18 || algo == 24) {
             printf("请输入物品数量（如1000、2000、5000等）：");
             scanf("%d", &n);
         } else if (algo == 5) { // 四种算法一起运行
@@ -264,10 +659,10 @@ int main() {
             int n_bf = n > 20 ? 20 : n;
             int* selected_bf = (int*)calloc(n_bf, sizeof(int));
             double max_value_bf = 0;
-            clock_t start_bf = clock();
+            uint64_t start_bf = knapsack_now_ns();
             brute_force(items_all, n_bf, capacity, selected_bf, &max_value_bf);
-            clock_t end_bf = clock();
-            double time_bf = ((double)(end_bf - start_bf) * 1000) / CLOCKS_PER_SEC;
+            uint64_t end_bf = knapsack_now_ns();
+            double time_bf = (end_bf - start_bf) / 1e6;
             printf("\n【蛮力法】(物品数:%d)\n", n_bf);
             double total_weight_bf = 0;
             int count_bf = 0;
@@ -288,10 +683,10 @@ int main() {
             int* selected_bt = (int*)calloc(n_bf, sizeof(int));
             int* curr_selected_bt = (int*)calloc(n_bf, sizeof(int));
             double max_value_bt = 0;
-            clock_t start_bt = clock();
+            uint64_t start_bt = knapsack_now_ns();
             backtrack(items_all, n_bf, capacity, 0, 0, 0, &max_value_bt, curr_selected_bt, selected_bt);
-            clock_t end_bt = clock();
-            double time_bt = ((double)(end_bt - start_bt) * 1000) / CLOCKS_PER_SEC;
+            uint64_t end_bt = knapsack_now_ns();
+            double time_bt = (end_bt - start_bt) / 1e6;
             printf("\n【回溯法】(物品数:%d)\n", n_bf);
             double total_weight_bt = 0;
             int count_bt = 0;
@@ -312,10 +707,10 @@ int main() {
             // 动态规划法（n个物品）
             int* selected_dp = (int*)calloc(n, sizeof(int));
             double max_value_dp = 0;
-            clock_t start_dp = clock();
+            uint64_t start_dp = knapsack_now_ns();
             dynamic_programming(items_all, n, capacity, selected_dp, &max_value_dp);
-            clock_t end_dp = clock();
-            double time_dp = ((double)(end_dp - start_dp) * 1000) / CLOCKS_PER_SEC;
+            uint64_t end_dp = knapsack_now_ns();
+            double time_dp = (end_dp - start_dp) / 1e6;
             printf("\n【动态规划法】(物品数:%d)\n", n);
             double total_weight_dp = 0;
             int count_dp = 0;
@@ -335,10 +730,10 @@ int main() {
             // 贪心法（n个物品）
             int* selected_gr = (int*)calloc(n, sizeof(int));
             double max_value_gr = 0;
-            clock_t start_gr = clock();
+            uint64_t start_gr = knapsack_now_ns();
             greedy(items_all, n, capacity, selected_gr, &max_value_gr);
-            clock_t end_gr = clock();
-            double time_gr = ((double)(end_gr - start_gr) * 1000) / CLOCKS_PER_SEC;
+            uint64_t end_gr = knapsack_now_ns();
+            double time_gr = (end_gr - start_gr) / 1e6;
             printf("\n【贪心法】(物品数:%d)\n", n);
             double total_weight_gr = 0;
             int count_gr = 0;
@@ -357,16 +752,16 @@ int main() {
 
             // 生成Excel（CSV）文件
             int save_count = n > 1000 ? 1000 : n;
-            FILE* fp = fopen("d:\\C\\items.csv", "w");
+            FILE* fp = fopen("items.csv", "w");
             if (fp) {
                 fprintf(fp, "物品编号,物品重量,物品价值\n");
                 for (int i = 0; i < save_count; i++) {
                     fprintf(fp, "%d,%.2f,%.2f\n", items_all[i].id, items_all[i].weight, items_all[i].value);
                 }
                 fclose(fp);
-                printf("已生成 d:\\C\\items.csv 文件（保存前%d个物品数据，可用Excel打开）。\n", save_count);
+                printf("已生成 items.csv 文件（保存前%d个物品数据，可用Excel打开）。\n", save_count);
             } else {
-                printf("无法创建 d:\\C\\items.csv 文件！\n");
+                printf("无法创建 items.csv 文件！\n");
             }
 
             char cwd[260];
@@ -379,130 +774,559 @@ int main() {
             int n_list[] = {5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24};
             int n_case = sizeof(n_list) / sizeof(n_list[0]);
             double capacity = 1000.0;
-            FILE* fpr = fopen("d:\\C\\result_compare.csv", "w");
+            // 与表头各列对应的算法；每个规模的数据由固定种子生成，每列为多次计时的中位数
+            const char* keys[] = {"brute", "gray", "backtrack", "prune", "dp", "greedy", "iter", "iter_prune"};
+            int k_case = sizeof(keys) / sizeof(keys[0]);
+            FILE* fpr = fopen("result_compare.csv", "w");
             if (fpr) {
-                fprintf(fpr, "物品数,蛮力法(ms),回溯法(ms),回溯剪枝(ms),动态规划(ms),贪心法(ms)\n");
+                fprintf(fpr, "物品数,蛮力法(ms),格雷码并行蛮力(ms),回溯法(ms),回溯剪枝(ms),动态规划(ms),贪心法(ms),迭代回溯(ms),迭代剪枝(ms)\n");
                 for (int idx = 0; idx < n_case; idx++) {
                     int n = n_list[idx];
                     Item* items = (Item*)malloc(n * sizeof(Item));
+                    Item* work = (Item*)malloc(n * sizeof(Item));
+                    int* selected = (int*)calloc(n, sizeof(int));
+                    gen_seed = bench_case_seed(n, 0);
                     generate_items(items, n);
-
-                    // 蛮力法
-                    int* selected_bf = (int*)calloc(n, sizeof(int));
-                    double max_value_bf = 0;
-                    clock_t start_bf = clock();
-                    brute_force(items, n, capacity, selected_bf, &max_value_bf);
-                    clock_t end_bf = clock();
-                    double time_bf = ((double)(end_bf - start_bf) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_bf);
-
-                    // 回溯法
-                    int* selected_bt = (int*)calloc(n, sizeof(int));
-                    int* curr_selected_bt = (int*)calloc(n, sizeof(int));
-                    double max_value_bt = 0;
-                    clock_t start_bt = clock();
-                    backtrack(items, n, capacity, 0, 0, 0, &max_value_bt, curr_selected_bt, selected_bt);
-                    clock_t end_bt = clock();
-                    double time_bt = ((double)(end_bt - start_bt) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_bt);
-                    free(curr_selected_bt);
-
-                    // 回溯剪枝
-                    int* selected_btp = (int*)calloc(n, sizeof(int));
-                    int* curr_selected_btp = (int*)calloc(n, sizeof(int));
-                    double max_value_btp = 0;
-                    double remain_value = 0;
-                    for (int i = 0; i < n; i++) remain_value += items[i].value;
-                    clock_t start_btp = clock();
-                    backtrack_prune(items, n, capacity, 0, 0, 0, &max_value_btp, curr_selected_btp, selected_btp, remain_value);
-                    clock_t end_btp = clock();
-                    double time_btp = ((double)(end_btp - start_btp) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_btp);
-                    free(curr_selected_btp);
-
-                    // 动态规划法
-                    int* selected_dp = (int*)calloc(n, sizeof(int));
-                    double max_value_dp = 0;
-                    clock_t start_dp = clock();
-                    dynamic_programming(items, n, capacity, selected_dp, &max_value_dp);
-                    clock_t end_dp = clock();
-                    double time_dp = ((double)(end_dp - start_dp) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_dp);
-
-                    // 贪心法
-                    int* selected_gr = (int*)calloc(n, sizeof(int));
-                    double max_value_gr = 0;
-                    clock_t start_gr = clock();
-                    greedy(items, n, capacity, selected_gr, &max_value_gr);
-                    clock_t end_gr = clock();
-                    double time_gr = ((double)(end_gr - start_gr) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_gr);
-
-                    fprintf(fpr, "%d,%.3f,%.3f,%.3f,%.3f,%.3f\n", n, time_bf, time_bt, time_btp, time_dp, time_gr);
+                    fprintf(fpr, "%d", n);
+                    for (int k = 0; k < k_case; k++) {
+                        const BenchSolver* solver = bench_find_solver(keys[k]);
+                        BenchStats st;
+                        bench_measure(solver->solve, items, solver->mutates ? work : NULL, n, capacity, selected,
+                                      BENCH_WARMUP, BENCH_TRIALS, &st);
+                        fprintf(fpr, ",%.4f", st.median_ms);
+                    }
+                    fprintf(fpr, "\n");
                     free(items);
+                    free(work);
+                    free(selected);
                 }
                 fclose(fpr);
-                printf("已生成 d:\\C\\result_compare.csv 文件。\n");
+                printf("已生成 result_compare.csv 文件（各列为 %d 次计时的中位数）。\n", BENCH_TRIALS);
             }
             continue;
         } else if (algo == 7) { // 大规模只对比DP和贪心
-            // 增加采样点
-            int n_list[] = {50, 100, 200, 500, 1000, 2000, 3000, 4000, 5000, 6000, 8000, 10000, 12000, 16000, 20000, 24000, 28000, 32000};
+            // 增加采样点；超过 SWEEP_DP_MAX_N 的规模只跑贪心类算法，其余列留空
+            int n_list[] = {50, 100, 200, 500, 1000, 2000, 3000, 4000, 5000, 6000, 8000, 10000, 12000, 16000, 20000, 24000, 28000, 32000,
+                            100000, 200000, 500000, 1000000, 2000000, 5000000};
             int n_case = sizeof(n_list) / sizeof(n_list[0]);
             double capacity = 1000.0;
-            FILE* fpr = fopen("d:\\C\\result_compare2.csv", "w");
+            FILE* fpr = fopen("result_compare2.csv", "w");
             if (fpr) {
-                // 修改表头
-                fprintf(fpr, "物品数,动态规划(ms),快排贪心(ms),选择排序贪心(ms)\n");
-                // 先生成最大规模的数据
+                // 时间列为多次计时的中位数
+                fprintf(fpr, "物品数,动态规划(ms),快排贪心(ms),选择排序贪心(ms),动态规划内存(MB),滚动DP(ms),滚动DP内存(MB),滚动DP标量(ms),快速选择贪心(ms),核心算法(ms),稀疏DP(ms),稀疏DP状态数,整数DP(ms),整数DP内存(MB)\n");
+                // 先按固定种子生成最大规模的数据，各规模取其前 n 个
                 int max_n = n_list[n_case - 1];
                 Item* items_all = (Item*)malloc(max_n * sizeof(Item));
+                Item* items_work = (Item*)malloc(max_n * sizeof(Item)); // 贪心法会对数组排序，每次从 items_all 复制一份
+                int* selected = (int*)calloc(max_n, sizeof(int));
+                gen_seed = bench_case_seed(max_n, 0);
                 generate_items(items_all, max_n);
 
                 for (int idx = 0; idx < n_case; idx++) {
                     int n = n_list[idx];
                     Item* items = items_all; // 直接用指针，不再malloc/free
+                    double time_dp = -1, time_gr_sel = -1, mem_dp = -1, time_dpr = -1, mem_dpr = -1, time_dps = -1;
+                    double time_dpi = -1, mem_dpi = -1;
+                    BenchStats st;
+
+                    if (n <= SWEEP_DP_MAX_N) {
+                        // 动态规划法
+                        mem_reset_peak();
+                        bench_measure(dynamic_programming, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_dp = st.median_ms;
+                        mem_dp = mem_peak_bytes() / (1024.0 * 1024.0);
+
+                        // 滚动数组动态规划
+                        mem_reset_peak();
+                        bench_measure(dynamic_programming_rolling, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_dpr = st.median_ms;
+                        mem_dpr = mem_peak_bytes() / (1024.0 * 1024.0);
+                        double max_value_dpr = st.value;
+
+                        // 滚动数组动态规划（强制标量内核，用于对比SIMD加速比）
+                        dp_set_simd(0);
+                        bench_measure(dynamic_programming_rolling, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_dps = st.median_ms;
+                        dp_set_simd(-1);
+                        if (st.value != max_value_dpr) {
+                            printf("警告：n=%d 时SIMD内核与标量内核结果不一致！\n", n);
+                        }
+
+                        // 整数定点动态规划（两位小数下与 double 版最优值相同）
+                        mem_reset_peak();
+                        bench_measure(dynamic_programming_int, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_dpi = st.median_ms;
+                        mem_dpi = mem_peak_bytes() / (1024.0 * 1024.0);
+                        if (fabs(st.value - max_value_dpr) > 0.005) {
+                            printf("警告：n=%d 时整数DP与滚动DP结果不一致！\n", n);
+                        }
 
-                    // 动态规划法
-                    int* selected_dp = (int*)calloc(n, sizeof(int));
-                    double max_value_dp = 0;
-                    clock_t start_dp = clock();
-                    dynamic_programming(items, n, capacity, selected_dp, &max_value_dp);
-                    clock_t end_dp = clock();
-                    double time_dp = ((double)(end_dp - start_dp) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_dp);
-
-                    // 快排贪心法（qsort）
-                    int* selected_gr = (int*)calloc(n, sizeof(int));
-                    double max_value_gr = 0;
-                    clock_t start_gr = clock();
-                    greedy(items, n, capacity, selected_gr, &max_value_gr);
-                    clock_t end_gr = clock();
-                    double time_gr = ((double)(end_gr - start_gr) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_gr);
-
-                    // 选择排序贪心法
-                    int* selected_gr_sel = (int*)calloc(n, sizeof(int));
-                    double max_value_gr_sel = 0;
-                    clock_t start_gr_sel = clock();
-                    greedy_selection(items, n, capacity, selected_gr_sel, &max_value_gr_sel);
-                    clock_t end_gr_sel = clock();
-                    double time_gr_sel = ((double)(end_gr_sel - start_gr_sel) * 1000) / CLOCKS_PER_SEC;
-                    free(selected_gr_sel);
-
-                    fprintf(fpr, "%d,%.3f,%.3f,%.3f\n", n, time_dp, time_gr, time_gr_sel);
+                        // 选择排序贪心法
+                        bench_measure(greedy_selection, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_gr_sel = st.median_ms;
+                    }
+
+                    // 快排贪心法（qsort），每次计时前从 items_all 复制
+                    bench_measure(greedy, items, items_work, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                    double time_gr = st.median_ms;
+
+                    // 快速选择贪心法
+                    bench_measure(greedy_fast, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                    double time_grf = st.median_ms;
+
+                    // 核心算法
+                    bench_measure(core_solver, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                    double time_core = st.median_ms;
+
+                    // 稀疏动态规划
+                    double time_sp = -1, states_sp = -1;
+                    if (n <= SWEEP_SPARSE_MAX_N) {
+                        bench_measure(sparse_dp, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        time_sp = st.median_ms;
+                        states_sp = (double)sparse_last_states;
+                    }
+
+                    fprintf(fpr, "%d", n);
+                    fprint_field(fpr, time_dp, 4);
+                    fprint_field(fpr, time_gr, 4);
+                    fprint_field(fpr, time_gr_sel, 4);
+                    fprint_field(fpr, mem_dp, 2);
+                    fprint_field(fpr, time_dpr, 4);
+                    fprint_field(fpr, mem_dpr, 2);
+                    fprint_field(fpr, time_dps, 4);
+                    fprint_field(fpr, time_grf, 4);
+                    fprint_field(fpr, time_core, 4);
+                    fprint_field(fpr, time_sp, 4);
+                    fprint_field(fpr, states_sp, 0);
+                    fprint_field(fpr, time_dpi, 4);
+                    fprint_field(fpr, mem_dpi, 2);
+                    fprintf(fpr, "\n");
                 }
                 free(items_all); // 只需释放一次
+                free(items_work);
+                free(selected);
+                fclose(fpr);
+                printf("已生成 result_compare2.csv 文件（时间列为 %d 次计时的中位数）。\n", BENCH_TRIALS);
+            }
+            continue;
+        } else if (algo == 10) { // 多线程DP扩展性测试
+            int n_list[] = {1000, 2000, 5000, 10000, 20000};
+            int n_case = sizeof(n_list) / sizeof(n_list[0]);
+            int thread_list[] = {1, 2, 4, 8};
+            int t_case = sizeof(thread_list) / sizeof(thread_list[0]);
+            double capacity = 1000.0;
+            FILE* fpr = fopen("result_parallel.csv", "w");
+            if (fpr) {
+                fprintf(fpr, "物品数,1线程(ms),2线程(ms),4线程(ms),8线程(ms)\n");
+                int max_n = n_list[n_case - 1];
+                Item* items_all = (Item*)malloc(max_n * sizeof(Item));
+                int* selected_par = (int*)calloc(max_n, sizeof(int));
+                gen_seed = bench_case_seed(max_n, 0);
+                generate_items(items_all, max_n);
+
+                for (int idx = 0; idx < n_case; idx++) {
+                    int n = n_list[idx];
+                    double time_base = 0;
+                    fprintf(fpr, "%d", n);
+                    printf("物品数 %d：", n);
+                    for (int t = 0; t < t_case; t++) {
+                        BenchStats st;
+                        bench_threads = thread_list[t];
+                        bench_measure(bench_dp_parallel, items_all, NULL, n, capacity, selected_par, BENCH_WARMUP, BENCH_TRIALS, &st);
+                        double time_par = st.median_ms;
+                        if (t == 0) time_base = time_par;
+                        fprintf(fpr, ",%.3f", time_par);
+                        printf(" %d线程 %.2f ms（加速比 %.2f）", thread_list[t], time_par, time_base / time_par);
+                    }
+                    bench_threads = 0;
+                    fprintf(fpr, "\n");
+                    printf("\n");
+                }
+                free(items_all);
+                free(selected_par);
+                fclose(fpr);
+                printf("已生成 result_parallel.csv 文件。\n");
+            }
+            continue;
+        } else if (algo == 22) { // 基准测试
+            char sizes[512], caps[512], algos[512];
+            BenchConfig cfg;
+            memset(&cfg, 0, sizeof(cfg));
+            printf("请输入物品数列表（逗号分隔，如 100,1000,10000）：");
+            scanf("%511s", sizes);
+            printf("请输入容量列表（逗号分隔，如 1000,10000）：");
+            scanf("%511s", caps);
+            printf("请输入算法列表（逗号分隔，可选：");
+            for (int i = 0; i < bench_solver_count; i++) printf("%s%s", i ? "," : "", bench_solvers[i].key);
+            printf("）：");
+            scanf("%511s", algos);
+            printf("请输入计时次数：");
+            scanf("%d", &cfg.trials);
+            cfg.size_count = bench_parse_ints(sizes, cfg.sizes, BENCH_MAX_GRID);
+            cfg.capacity_count = bench_parse_doubles(caps, cfg.capacities, BENCH_MAX_GRID);
+            cfg.solver_count = bench_parse_solvers(algos, cfg.solvers, BENCH_MAX_GRID);
+            cfg.warmup = BENCH_WARMUP;
+            cfg.csv_path = "result_bench.csv";
+            cfg.json_path = "result_bench.json";
+            if (cfg.solver_count > 0 && bench_run(&cfg) == 0) {
+                printf("已生成 result_bench.csv 与 result_bench.json 文件。\n");
+            }
+            continue;
+        } else if (algo == 23) { // 选择实例类型
+            static const char* class_desc[KS_GEN_CLASS_COUNT] = {
+                "不相关（重量 1~100，价值 100~1000）", "弱相关（价值在重量 ±10 内）", "强相关（价值 = 重量 + 10）",
+                "反强相关（重量 = 价值 + 10）", "子集和（价值 = 重量）", "相近重量（重量 99~100）", "张成（2 个物品的 1~10 倍）"
+            };
+            for (int c = 0; c < KS_GEN_CLASS_COUNT; c++) {
+                printf("%d. %s %s%s\n", c + 1, knapsack_gen_class_name((KnapsackInstanceClass)c), class_desc[c],
+                       c == (int)gen_class ? "（当前）" : "");
+            }
+            int choice;
+            printf("请选择实例类型（之后所有模式生成的数据都使用该类型）：");
+            scanf("%d", &choice);
+            if (choice < 1 || choice > KS_GEN_CLASS_COUNT) {
+                printf("无效选项！\n");
+                continue;
+            }
+            gen_class = (KnapsackInstanceClass)(choice - 1);
+            printf("请输入试生成的物品数（如 10000000，0 跳过）：");
+            scanf("%d", &n);
+            if (n > 0) {
+                Item* items = (Item*)malloc(n * sizeof(Item));
+                if (!items) {
+                    printf("内存不足！\n");
+                    continue;
+                }
+                uint64_t start = knapsack_now_ns();
+                generate_items(items, n);
+                double ms = (knapsack_now_ns() - start) / 1e6;
+                double total_weight = 0, total_value = 0;
+                for (int i = 0; i < n; i++) {
+                    total_weight += items[i].weight;
+                    total_value += items[i].value;
+                }
+                printf("生成 %d 个物品用时 %.2f ms（%.1f 百万个/秒），总重量 %.2f，总价值 %.2f\n", n, ms,
+                       n / ms / 1000.0, total_weight, total_value);
+                free(items);
+            }
+            continue;
+        } else if (algo == 25) { // 增量求解
+            double capacity;
+            printf("请输入物品数量（如1000、5000等）：");
+            scanf("%d", &n);
+            printf("请输入最大背包容量（如1000.00）：");
+            scanf("%lf", &capacity);
+            int extra = 10; // 之后再加入/删除的物品数
+            Item* items = (Item*)malloc((n + extra) * sizeof(Item));
+            int* selected = (int*)calloc(n + extra, sizeof(int));
+            KnapsackIncremental* inc = knapsack_inc_create(capacity);
+            if (!items || !selected || !inc) {
+                printf("内存不足！\n");
+                free(items);
+                free(selected);
+                knapsack_inc_destroy(inc);
+                continue;
+            }
+            generate_items(items, n + extra);
+            uint64_t start = knapsack_now_ns();
+            for (int i = 0; i < n; i++) knapsack_inc_add(inc, &items[i]);
+            printf("逐个加入 %d 个物品共 %.2f ms，最优价值 %.2f\n", n, (knapsack_now_ns() - start) / 1e6,
+                   knapsack_inc_value(inc, capacity));
+            double add_ms = 0, remove_last_ms = 0, remove_any_ms = 0;
+            for (int k = 0; k < extra; k++) {
+                start = knapsack_now_ns();
+                knapsack_inc_add(inc, &items[n + k]);
+                add_ms += (knapsack_now_ns() - start) / 1e6;
+            }
+            for (int k = 0; k < extra / 2; k++) { // 删除最近加入的物品
+                start = knapsack_now_ns();
+                knapsack_inc_remove(inc, items[n + extra - 1 - k].id);
+                remove_last_ms += (knapsack_now_ns() - start) / 1e6;
+            }
+            for (int k = 0; k < extra / 2; k++) { // 删除靠前的物品，需要从检查点重放
+                start = knapsack_now_ns();
+                knapsack_inc_remove(inc, items[(long long)n * (k + 1) / (extra / 2 + 1)].id);
+                remove_any_ms += (knapsack_now_ns() - start) / 1e6;
+            }
+            printf("加入一个物品平均 %.3f ms，删除最近加入的物品平均 %.3f ms，删除靠前的物品平均 %.3f ms\n",
+                   add_ms / extra, remove_last_ms / (extra / 2), remove_any_ms / (extra / 2));
+
+            // 与整数DP从头求解对比
+            int count = knapsack_inc_count(inc);
+            memcpy(items, knapsack_inc_items(inc), count * sizeof(Item));
+            double max_value = 0;
+            start = knapsack_now_ns();
+            dynamic_programming_int(items, count, capacity, selected, &max_value);
+            printf("从头求解 %.2f ms，最优价值 %.2f；增量结果 %.2f\n", (knapsack_now_ns() - start) / 1e6, max_value,
+                   knapsack_inc_value(inc, capacity));
+            for (int k = 1; k <= 4; k++) {
+                double c = capacity * k / 4;
+                knapsack_inc_select(inc, c, selected);
+                int picked = 0;
+                for (int i = 0; i < count; i++) picked += selected[i];
+                printf("容量 %.2f：最优价值 %.2f，选中 %d 个物品\n", c, knapsack_inc_value(inc, c), picked);
+            }
+            knapsack_inc_destroy(inc);
+            free(items);
+            free(selected);
+            continue;
+        } else if (algo == 26) { // 多容量查询
+            double capacity;
+            int queries;
+            printf("请输入物品数量（如1000、5000等）：");
+            scanf("%d", &n);
+            printf("请输入最大背包容量（如1000.00）：");
+            scanf("%lf", &capacity);
+            printf("请输入查询的容量个数（如500）：");
+            scanf("%d", &queries);
+            if (queries < 1) queries = 1;
+            Item* items = (Item*)malloc(n * sizeof(Item));
+            int* selected = (int*)calloc(n, sizeof(int));
+            double* caps = (double*)malloc(queries * sizeof(double));
+            double* values = (double*)malloc(queries * sizeof(double));
+            if (!items || !selected || !caps || !values) {
+                printf("内存不足！\n");
+                free(items);
+                free(selected);
+                free(caps);
+                free(values);
+                continue;
+            }
+            generate_items(items, n);
+            for (int k = 0; k < queries; k++) caps[k] = queries > 1 ? capacity * k / (queries - 1) : capacity;
+
+            uint64_t start = knapsack_now_ns();
+            KnapsackCapacityTable* table = knapsack_table_build(items, n, capacity);
+            double build_ms = (knapsack_now_ns() - start) / 1e6;
+            if (!table) {
+                printf("内存不足，无法求解！\n");
+            } else {
+                start = knapsack_now_ns();
+                knapsack_table_values(table, caps, queries, values);
+                double query_ms = (knapsack_now_ns() - start) / 1e6;
+                printf("求解一次 %.2f ms，回答 %d 个容量的查询 %.4f ms\n", build_ms, queries, query_ms);
+
+                // 抽查几个容量：逐个调用整数DP，估算逐个求解的总耗时
+                double single_ms = 0;
+                int checks = queries < 3 ? queries : 3;
+                for (int k = 0; k < checks; k++) {
+                    int q = (int)((long long)(queries - 1) * (k + 1) / checks);
+                    double max_value = 0;
+                    start = knapsack_now_ns();
+                    dynamic_programming_int(items, n, caps[q], selected, &max_value);
+                    single_ms += (knapsack_now_ns() - start) / 1e6;
+                    printf("容量 %.2f：查表 %.2f，单独求解 %.2f%s\n", caps[q], values[q], max_value,
+                           fabs(values[q] - max_value) > 0.005 ? "（不一致！）" : "");
+                }
+                printf("逐个求解 %d 个容量预计需要 %.2f ms\n", queries, single_ms / checks * queries);
+
+                // 只重建中间容量的选择
+                double c = caps[queries / 2];
+                start = knapsack_now_ns();
+                if (knapsack_table_select(table, &c, 1, &selected) == 0) {
+                    printf("重建容量 %.2f 的选择用时 %.2f ms\n", c, (knapsack_now_ns() - start) / 1e6);
+                    print_result(items, n, selected, knapsack_table_value(table, c), 0, c);
+                }
+                knapsack_table_destroy(table);
+            }
+            free(items);
+            free(selected);
+            free(caps);
+            free(values);
+            continue;
+        } else if (algo == 27) { // 限时求解
+            double capacity, deadline_ms;
+            printf("请输入物品数量（如100000、1000000等）：");
+            scanf("%d", &n);
+            printf("请输入背包容量（如10000.00、100000.00、1000000.00）：");
+            scanf("%lf", &capacity);
+            printf("请输入截止时间（毫秒，可输入多个，逗号分隔，如 0,10,100,1000）：");
+            char deadlines[256];
+            scanf("%255s", deadlines);
+            double deadline_list[BENCH_MAX_GRID];
+            int deadline_count = bench_parse_doubles(deadlines, deadline_list, BENCH_MAX_GRID);
+            Item* items = (Item*)malloc(n * sizeof(Item));
+            int* selected = (int*)calloc(n, sizeof(int));
+            if (!items || !selected) {
+                printf("内存不足！\n");
+                free(items);
+                free(selected);
+                continue;
+            }
+            generate_items(items, n);
+            for (int d = 0; d < deadline_count; d++) {
+                deadline_ms = deadline_list[d];
+                double max_value = 0;
+                KnapsackAnytimeStats st;
+                knapsack_anytime(items, n, capacity, deadline_ms, selected, &max_value, &st);
+                print_status(algo);
+                printf("截止 %.0f ms：价值 %.2f，上界 %.2f，差距 %.4f%%，核大小 %d（%d 轮），实际耗时 %.2f ms%s\n",
+                       deadline_ms, st.lower, st.upper, st.gap * 100, st.core_size, st.iterations, st.elapsed_ms,
+                       st.gap == 0 ? "（已证明最优）" : "");
+            }
+            free(items);
+            free(selected);
+            continue;
+        } else if (algo == 28) { // DP缓存分块对比
+            double max_capacity;
+            printf("请输入物品数量（如32、64）：");
+            scanf("%d", &n);
+            printf("请输入最大背包容量（容量从40.95起每次翻倍，两行工作集约为 容量×1600 字节，如 335544.31 约 512MB）：");
+            scanf("%lf", &max_capacity);
+            if (n <= 0) continue;
+            FILE* fpr = fopen("result_blocking.csv", "w");
+            if (fpr) {
+                fprintf(fpr, "容量格数,两行工作集(KB),逐行(ms),分块(ms),逐行(ns/格),分块(ns/格),加速比\n");
+                Item* items = (Item*)malloc(n * sizeof(Item));
+                int* selected = (int*)calloc(n, sizeof(int));
+                generate_items(items, n);
+                long long max_cells = (long long)(max_capacity * 100 + 0.5) + 1;
+                for (long long cells = 4096; cells <= max_cells; cells *= 2) {
+                    double capacity = (cells - 1) / 100.0;
+                    BenchStats st;
+                    dp_set_blocking(0);
+                    bench_measure(dynamic_programming_rolling, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                    double time_plain = st.median_ms;
+                    double value_plain = st.value;
+                    dp_set_blocking(16);
+                    bench_measure(dynamic_programming_rolling, items, NULL, n, capacity, selected, BENCH_WARMUP, BENCH_TRIALS, &st);
+                    double time_block = st.median_ms;
+                    dp_set_blocking(-1);
+                    if (st.value != value_plain) {
+                        printf("警告：容量 %.2f 时分块与逐行结果不一致！\n", capacity);
+                    }
+                    double cell_count = (double)n * cells;
+                    fprintf(fpr, "%lld,%.0f,%.3f,%.3f,%.3f,%.3f,%.2f\n", cells, cells * 2 * sizeof(double) / 1024.0,
+                            time_plain, time_block, time_plain * 1e6 / cell_count, time_block * 1e6 / cell_count,
+                            time_plain / time_block);
+                    printf("容量格数 %lld（两行 %.0f KB）：逐行 %.3f ns/格，分块 %.3f ns/格，加速比 %.2f\n", cells,
+                           cells * 2 * sizeof(double) / 1024.0, time_plain * 1e6 / cell_count,
+                           time_block * 1e6 / cell_count, time_plain / time_block);
+                }
+                free(items);
+                free(selected);
                 fclose(fpr);
-                printf("已生成 d:\\C\\result_compare2.csv 文件。\n");
+                printf("已生成 result_blocking.csv 文件（时间列为 %d 次计时的中位数）。\n", BENCH_TRIALS);
             }
             continue;
+        } else if (algo == 29) { // 正确性自检
+            selftest_main();
+            continue;
+        } else if (algo == 19) { // 从CSV文件读取物品
+            char path[260];
+            int mode;
+            printf("请输入CSV文件路径（格式：物品编号,物品重量,物品价值）：");
+            scanf("%259s", path);
+            printf("读取方式（1. mmap整体读取并求解 2. 分块流式读取，适合比内存大的文件）：");
+            scanf("%d", &mode);
+            KnapsackLoadStats stats;
+            if (mode == 2) {
+                CsvTotals totals = {0, 0};
+                long long rows = knapsack_stream_csv(path, 0, 0, csv_totals_sink, &totals, &stats);
+                if (rows < 0) {
+                    printf("无法读取 %s 文件！\n", path);
+                    continue;
+                }
+                printf("物品数: %lld（跳过 %lld 行），总重量: %.2f，总价值: %.2f\n", rows, stats.skipped, totals.weight, totals.value);
+                printf("读取 %.2f MB，耗时 %.3f s，速度 %.1f MB/s\n\n", stats.bytes / (1024.0 * 1024.0), stats.seconds, stats.mb_per_s);
+                continue;
+            }
+            int count;
+            Item* items_csv = knapsack_load_csv(path, 0, &count, &stats);
+            if (!items_csv) {
+                printf("无法读取 %s 文件！\n", path);
+                continue;
+            }
+            printf("物品数: %d（跳过 %lld 行），读取 %.2f MB，耗时 %.3f s，速度 %.1f MB/s\n",
+                   count, stats.skipped, stats.bytes / (1024.0 * 1024.0), stats.seconds, stats.mb_per_s);
+            double capacity;
+            printf("请输入背包容量（如10000.00、100000.00、1000000.00）：");
+            scanf("%lf", &capacity);
+            int* selected_csv = (int*)calloc(count > 0 ? count : 1, sizeof(int));
+            KnapsackContext* ctx = knapsack_context_create(0);
+            double max_value_csv = 0;
+            uint64_t start_csv = knapsack_now_ns();
+            if (knapsack_solve(ctx, knapsack_pick_algo(count, capacity), items_csv, count, capacity, selected_csv, &max_value_csv) != 0) {
+                printf("内存不足，无法求解！\n");
+            }
+            uint64_t end_csv = knapsack_now_ns();
+            print_result(items_csv, count, selected_csv, max_value_csv, (end_csv - start_csv) / 1e6, capacity);
+            knapsack_context_destroy(ctx);
+            free(selected_csv);
+            free(items_csv);
+            continue;
+        } else if (algo == 20) { // CSV转换为二进制实例文件
+            char csv_path[260], bin_path[260];
+            double capacity;
+            int with_int;
+            printf("请输入CSV文件路径：");
+            scanf("%259s", csv_path);
+            printf("请输入输出的二进制文件路径：");
+            scanf("%259s", bin_path);
+            printf("请输入记录在文件中的背包容量：");
+            scanf("%lf", &capacity);
+            printf("是否附带×100整数重量列（1. 是 0. 否）：");
+            scanf("%d", &with_int);
+            KnapsackLoadStats stats;
+            if (knapsack_convert_csv(csv_path, bin_path, capacity, with_int ? KNAPSACK_BIN_INT_WEIGHT : 0, &stats) != 0) {
+                printf("转换失败！\n");
+                continue;
+            }
+            printf("已生成 %s 文件：物品数 %lld（跳过 %lld 行），CSV读取速度 %.1f MB/s\n\n", bin_path, stats.rows, stats.skipped, stats.mb_per_s);
+            continue;
+        } else if (algo == 21) { // 读取二进制实例文件并求解
+            char bin_path[260];
+            printf("请输入二进制实例文件路径：");
+            scanf("%259s", bin_path);
+            KnapsackColumns cols;
+            uint64_t start_open = knapsack_now_ns();
+            if (knapsack_open_binary(bin_path, &cols) != 0) {
+                printf("无法读取 %s 文件（文件不存在或版本不符）！\n", bin_path);
+                continue;
+            }
+            uint64_t end_open = knapsack_now_ns();
+            printf("物品数: %d，文件中的容量: %.2f，整数重量列: %s，打开耗时: %.3f ms\n", cols.n, cols.capacity,
+                   cols.int_weight ? "有" : "无", (end_open - start_open) / 1e6);
+            double capacity;
+            int method;
+            printf("请输入背包容量（0 表示使用文件中的容量）：");
+            scanf("%lf", &capacity);
+            if (capacity <= 0) capacity = cols.capacity;
+            printf("请选择算法（1. 快速选择贪心 2. 核心算法 3. 滚动数组动态规划）：");
+            scanf("%d", &method);
+            int* selected_bin = (int*)calloc(cols.n > 0 ? cols.n : 1, sizeof(int));
+            double max_value_bin = 0;
+            knapsack_last_status = KS_STATUS_OK;
+            uint64_t start_bin = knapsack_now_ns();
+            if (method == 1) greedy_fast_columns(&cols, capacity, selected_bin, &max_value_bin);
+            else if (method == 2) core_solver_columns(&cols, capacity, selected_bin, &max_value_bin);
+            else dynamic_programming_columns(&cols, capacity, selected_bin, &max_value_bin, 1);
+            uint64_t end_bin = knapsack_now_ns();
+            print_status(algo);
+            printf("选择的物品编号、重量、价值：\n");
+            int count = 0;
+            for (int i = 0; i < cols.n && count < 10; i++) { // 限制输出前10个物品
+                if (selected_bin[i]) {
+                    printf("物品 %d: 重量 %.2f, 价值 %.2f\n", cols.id[i], cols.weight[i], cols.value[i]);
+                    count++;
+                }
+            }
+            printf("总价值: %.2f, 执行时间: %.2f ms\n\n", max_value_bin, (end_bin - start_bin) / 1e6);
+            free(selected_bin);
+            knapsack_close_binary(&cols);
+            continue;
         }
 
         double capacity;
         printf("请输入背包容量（如10000.00、100000.00、1000000.00）：");
         scanf("%lf", &capacity);
 
+        int threads = 1;
+        if (algo == 9 || algo == 15) {
+            printf("请输入线程数：");
+            scanf("%d", &threads);
+        }
+
         // 单算法运行（原有逻辑）
         Item* items = (Item*)malloc(n * sizeof(Item));
         int* selected = (int*)calloc(n, sizeof(int));
@@ -511,7 +1335,9 @@ int main() {
         double max_value = 0;
 
         // 记录算法开始时间
-        clock_t start = clock();
+        mem_reset_peak();
+        knapsack_last_status = KS_STATUS_OK;
+        uint64_t start = knapsack_now_ns();
 
         if (algo == 1) {
             brute_force(items, n, capacity, selected, &max_value);
@@ -523,11 +1349,38 @@ int main() {
             dynamic_programming(items, n, capacity, selected, &max_value);
         } else if (algo == 4) {
             greedy(items, n, capacity, selected, &max_value);
+        } else if (algo == 8) {
+            printf("DP内核: %s\n", dp_simd_name());
+            dynamic_programming_rolling(items, n, capacity, selected, &max_value);
+        } else if (algo == 9) {
+            printf("DP内核: %s，线程数: %d\n", dp_simd_name(), threads);
+            dynamic_programming_parallel(items, n, capacity, selected, &max_value, threads);
+        } else if (algo == 11 || algo == 12) {
+            branch_and_bound(items, n, capacity, selected, &max_value, algo == 12);
+            printf("扩展结点数: %lld\n", bb_last_nodes);
+        } else if (algo == 13) {
+            backtrack_iterative(items, n, capacity, selected, &max_value, 1);
+        } else if (algo == 14) {
+            meet_in_middle(items, n, capacity, selected, &max_value);
+        } else if (algo == 15) {
+            brute_force_gray(items, n, capacity, selected, &max_value, threads);
+        } else if (algo == 16) {
+            greedy_fast(items, n, capacity, selected, &max_value);
+        } else if (algo == 17) {
+            core_solver(items, n, capacity, selected, &max_value);
+            printf("核大小: %d\n", core_last_size);
+        } else if (algo == 18) {
+            sparse_dp(items, n, capacity, selected, &max_value);
+            printf("累计保留状态数: %lld，单层最多: %d\n", sparse_last_states, sparse_last_max_list);
+        } else if (algo == 24) {
+            dynamic_programming_int(items, n, capacity, selected, &max_value);
+            printf("DP内核: %s，元素: int%d\n", dp_simd_name(), dp_int_last_bits);
         }
 
         // 记录算法结束时间
-        clock_t end = clock();
-        double time_ms = ((double)(end - start) * 1000) / CLOCKS_PER_SEC;
+        uint64_t end = knapsack_now_ns();
+        double time_ms = (end - start) / 1e6;
+        print_status(algo);
 
         // 输出结果
         printf("选择的物品编号、重量、价值：\n");
@@ -541,20 +1394,21 @@ int main() {
             }
         }
         printf("总重量: %.2f, 总价值: %.2f\n", total_weight, max_value);
-        printf("算法执行时间: %.2f ms\n\n", time_ms);
+        printf("算法执行时间: %.2f ms\n", time_ms);
+        printf("峰值内存: %.2f MB\n\n", mem_peak_bytes() / (1024.0 * 1024.0));
 
         // 生成Excel（CSV）文件
         int save_count = n > 1000 ? 1000 : n;
-        FILE* fp = fopen("d:\\C\\items.csv", "w");
+        FILE* fp = fopen("items.csv", "w");
         if (fp) {
             fprintf(fp, "物品编号,物品重量,物品价值\n");
             for (int i = 0; i < save_count; i++) {
                 fprintf(fp, "%d,%.2f,%.2f\n", items[i].id, items[i].weight, items[i].value);
             }
             fclose(fp);
-            printf("已生成 d:\\C\\items.csv 文件（保存前%d个物品数据，可用Excel打开）。\n", save_count);
+            printf("已生成 items.csv 文件（保存前%d个物品数据，可用Excel打开）。\n", save_count);
         } else {
-            printf("无法创建 d:\\C\\items.csv 文件！\n");
+            printf("无法创建 items.csv 文件！\n");
         }
 
         char cwd[260];
@@ -1,21 +1,35 @@
+import sys
 import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib
 
+
+def load_results(path):
+    # 读取模式6的结果（宽表）；也接受 01bag bench 输出的长表，按算法展开成 "算法(ms)" 列（取第一个容量）
+    df = pd.read_csv(path)
+    if '算法' in df.columns:
+        df = df[df['容量'] == df['容量'].iloc[0]]
+        df = df.pivot(index='物品数', columns='算法', values='中位数(ms)')
+        df.columns = [f'{c}(ms)' for c in df.columns]
+        df = df.reset_index()
+        if '快排贪心(ms)' in df.columns:
+            df['贪心法(ms)'] = df['快排贪心(ms)']
+    return df
+
+
 try:
     # 设置中文字体
     matplotlib.rcParams['font.sans-serif'] = ['SimHei']
     matplotlib.rcParams['axes.unicode_minus'] = False
 
-    # 读取数据
-    df = pd.read_csv('d:/C/result_compare.csv')
+    # 读取数据（默认为当前目录下的 result_compare.csv，也可在命令行指定）
+    csv_path = sys.argv[1] if len(sys.argv) > 1 else 'result_compare.csv'
+    df = load_results(csv_path)
 
-    # 绘制五种算法运行时间曲线
-    plt.plot(df['物品数'], df['蛮力法(ms)'], marker='o', label='蛮力法')
-    plt.plot(df['物品数'], df['回溯法(ms)'], marker='s', label='回溯法')
-    plt.plot(df['物品数'], df['回溯剪枝(ms)'], marker='x', label='回溯剪枝')
-    plt.plot(df['物品数'], df['动态规划(ms)'], marker='^', label='动态规划')
-    plt.plot(df['物品数'], df['贪心法(ms)'], marker='d', label='贪心法')
+    # 绘制五种算法运行时间曲线（时间为多次计时的中位数，缺少的列跳过）
+    for name, marker in [('蛮力法', 'o'), ('回溯法', 's'), ('回溯剪枝', 'x'), ('动态规划', '^'), ('贪心法', 'd')]:
+        if f'{name}(ms)' in df.columns:
+            plt.plot(df['物品数'], df[f'{name}(ms)'], marker=marker, label=name)
 
     plt.xlabel('物品数')
     plt.ylabel('运行时间 (ms)')
@@ -24,8 +38,8 @@ try:
     plt.grid(axis='y', which='major', linestyle='--')
     plt.tight_layout()
 
-    # 保存图片到指定路径
-    save_path = 'd:/C/All_algorithm_time_comparison.png'
+    # 保存图片到当前目录
+    save_path = 'All_algorithm_time_comparison.png'
     plt.savefig(save_path, dpi=300, bbox_inches='tight')
     print(f"图表已成功保存到: {save_path}")
 
@@ -1,21 +1,37 @@
+import sys
 import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib
 
+
+def load_results(path):
+    # 读取模式7的结果（宽表）；也接受 01bag bench 输出的长表，按算法展开成 "算法(ms)" 列（取第一个容量）
+    df = pd.read_csv(path)
+    if '算法' in df.columns:
+        df = df[df['容量'] == df['容量'].iloc[0]]
+        df = df.pivot(index='物品数', columns='算法', values='中位数(ms)')
+        df.columns = [f'{c}(ms)' for c in df.columns]
+        df = df.reset_index()
+    return df
+
+
 try:
     # 设置中文字体
     matplotlib.rcParams['font.sans-serif'] = ['SimHei']
     matplotlib.rcParams['axes.unicode_minus'] = False
 
-    # 读取数据
-    df = pd.read_csv('d:/C/result_compare2.csv')
-    df['快排贪心法(ms)'] = df['快排贪心法(ms)'].replace(0, 0.1)  # 解决对数坐标下0无法显示的问题
-    df['选择排序贪心(ms)'] = df['选择排序贪心(ms)'].replace(0, 0.1)
+    # 读取数据（默认为当前目录下的 result_compare2.csv，也可在命令行指定）
+    csv_path = sys.argv[1] if len(sys.argv) > 1 else 'result_compare2.csv'
+    df = load_results(csv_path)
 
-    # 绘制三种算法运行时间曲线
-    plt.plot(df['物品数'], df['动态规划(ms)'], marker='o', label='动态规划')
-    plt.plot(df['物品数'], df['快排贪心法(ms)'], marker='s', label='快排贪心法')
-    plt.plot(df['物品数'], df['选择排序贪心(ms)'], marker='^', label='选择排序贪心')
+    # 绘制三种算法运行时间曲线（时间为多次计时的中位数，缺少的列跳过）
+    for name, marker in [('动态规划', 'o'), ('快排贪心', 's'), ('选择排序贪心', '^')]:
+        column = f'{name}(ms)'
+        if column not in df.columns and name == '快排贪心':
+            column = '快排贪心法(ms)'  # 旧版本输出的列名
+        if column in df.columns:
+            times = df[column].replace(0, 0.1)  # 解决对数坐标下0无法显示的问题
+            plt.plot(df['物品数'], times, marker=marker, label=name)
 
     plt.xlabel('物品数')
     plt.ylabel('运行时间 (ms)')
@@ -29,8 +45,8 @@ try:
     plt.legend()
     plt.tight_layout()
 
-    # 保存图片到指定路径
-    save_path = 'd:/C/dp_greedy_selection_time_comparison.png'
+    # 保存图片到当前目录
+    save_path = 'dp_greedy_selection_time_comparison.png'
     plt.savefig(save_path, dpi=300, bbox_inches='tight')
     print(f"图表已成功保存到: {save_path}")
 
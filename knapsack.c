@@ -0,0 +1,3907 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <float.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DP_X86_SIMD 1 // GCC/Clang 下启用 SSE2/AVX 内核（运行时检测）
+#endif
+#include "knapsack.h"
+
+// CPU 核数，作为多线程算法的默认线程数
+int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// 单调时钟，纳秒
+uint64_t knapsack_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart / freq.QuadPart) * 1000000000ULL +
+           (uint64_t)(count.QuadPart % freq.QuadPart) * 1000000000ULL / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// 内存统计：求解器的临时内存统一通过 scratch_* 分配，便于对比各算法的峰值内存
+static KS_THREAD_LOCAL size_t g_mem_current = 0; // 当前已分配字节数
+static KS_THREAD_LOCAL size_t g_mem_peak = 0;    // 峰值字节数
+
+#define SCRATCH_HEADER 16 // 每块内存前记录其大小和来源（16字节保证对齐）
+
+// 内存池：knapsack_solve 期间作为当前线程的活动内存池，scratch_malloc 从中顺序分配。
+// 池内释放的块若恰好在顶部则直接退回，否则等本次求解结束后整体重置；
+// 池不够时退回 malloc，并记下最高用量，下次求解前把池扩到这个大小
+typedef struct {
+    char* base;
+    size_t size;       // 池大小
+    size_t used;       // 已顺序分配的字节数
+    size_t overflow;   // 池外（malloc）分配的当前字节数
+    size_t high_water; // used + overflow 的最高值
+} ScratchArena;
+
+enum { SCRATCH_HEAP = 0, SCRATCH_POOL = 1, SCRATCH_SPILL = 2 }; // 块的来源：堆、池内、池满后溢出到堆
+
+static KS_THREAD_LOCAL ScratchArena* g_arena = NULL; // 当前线程的活动内存池
+static KS_THREAD_LOCAL int g_scratch_failed = 0;     // 求解期间是否出现过分配失败
+
+static size_t scratch_block_size(size_t size) {
+    return (size + 2 * SCRATCH_HEADER - 1) / SCRATCH_HEADER * SCRATCH_HEADER;
+}
+
+void* scratch_malloc(size_t size) {
+    ScratchArena* arena = g_arena;
+    size_t block = scratch_block_size(size);
+    char* p;
+    size_t kind;
+    if (arena && arena->size - arena->used >= block) {
+        p = arena->base + arena->used;
+        arena->used += block;
+        kind = SCRATCH_POOL;
+    } else {
+        p = (char*)malloc(size + SCRATCH_HEADER);
+        if (!p) {
+            g_scratch_failed = 1;
+            return NULL;
+        }
+        kind = SCRATCH_HEAP;
+        if (arena) {
+            arena->overflow += block;
+            kind = SCRATCH_SPILL;
+        }
+    }
+    if (arena && arena->used + arena->overflow > arena->high_water) arena->high_water = arena->used + arena->overflow;
+    ((size_t*)p)[0] = size;
+    ((size_t*)p)[1] = kind;
+    g_mem_current += size;
+    if (g_mem_current > g_mem_peak) g_mem_peak = g_mem_current;
+    return p + SCRATCH_HEADER;
+}
+
+void* scratch_calloc(size_t count, size_t size) {
+    void* p = scratch_malloc(count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+void scratch_free(void* ptr) {
+    if (!ptr) return;
+    char* p = (char*)ptr - SCRATCH_HEADER;
+    size_t size = ((size_t*)p)[0];
+    size_t kind = ((size_t*)p)[1];
+    g_mem_current -= size;
+    if (kind == SCRATCH_POOL) {
+        ScratchArena* arena = g_arena;
+        if (arena && p + scratch_block_size(size) == arena->base + arena->used) arena->used = p - arena->base;
+        return;
+    }
+    if (kind == SCRATCH_SPILL && g_arena) g_arena->overflow -= scratch_block_size(size);
+    free(p);
+}
+
+// 把峰值重置为当前用量，在每次计时前调用
+void mem_reset_peak(void) {
+    g_mem_peak = g_mem_current;
+}
+
+size_t mem_peak_bytes(void) {
+    return g_mem_peak;
+}
+
+// ---------------- 求解状态 ----------------
+// 库函数不向 stdout 输出提示（调用者的输出流可能正用来输出结果），出错或只用了部分物品时记在这里
+KS_THREAD_LOCAL int knapsack_last_status = KS_STATUS_OK;
+
+const char* knapsack_status_message(int status) {
+    switch (status) {
+    case KS_STATUS_OK: return "成功";
+    case KS_STATUS_NO_MEMORY: return "内存不足，无法求解！";
+    case KS_STATUS_TOO_MANY_STATES: return "状态数过多或内存不足，稀疏DP无法求解！";
+    case KS_STATUS_TRUNCATED: return "警告：物品数超过该算法的上限，只使用了前面的物品！";
+    default: return "未知状态";
+    }
+}
+
+// ---------------- 硬件性能计数器 ----------------
+// 用 perf_event_open 为调用线程打开一组计数器（周期、指令、缓存未命中、分支未命中），
+// 求解器在阶段边界调用 perf_mark 读一次计数并把差值记到上一阶段。未开启时 perf_mark 只检查一个线程局部标志；
+// 内核不允许（perf_event_paranoid、容器、虚拟机没有 PMU）或非 Linux 平台时打不开的计数器记为 -1，阶段耗时照常统计
+#define PERF_EVENTS 4
+
+typedef struct {
+    int enabled;
+    int ready;                                    // 开启过一次以后，slot 记录哪些计数器可用
+    int fds[PERF_EVENTS];                         // 各计数器的描述符，打不开为 -1
+    int leader;                                   // 组长描述符，整组一次 read 读出
+    int slot[PERF_EVENTS];                        // 各计数器在组读出结果中的位置，-1 表示不可用
+    int opened;                                   // 打开成功的计数器个数
+    uint64_t last[PERF_EVENTS];                   // 上一次 perf_mark 时的读数
+    uint64_t last_ns;
+    long long total[KS_PHASE_COUNT][PERF_EVENTS]; // 各阶段累计值
+    long long total_ns[KS_PHASE_COUNT];
+    long long calls[KS_PHASE_COUNT];
+} PerfState;
+
+static KS_THREAD_LOCAL PerfState g_perf;
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+static void perf_open_events(PerfState* ps) {
+    static const uint64_t configs[PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    ps->leader = -1;
+    ps->opened = 0;
+    for (int k = 0; k < PERF_EVENTS; k++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[k];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1; // 只统计用户态，perf_event_paranoid = 2 时也能打开
+        attr.exclude_hv = 1;
+        ps->fds[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, ps->leader, 0);
+        ps->slot[k] = ps->fds[k] >= 0 ? ps->opened++ : -1;
+        if (ps->fds[k] >= 0 && ps->leader < 0) ps->leader = ps->fds[k];
+    }
+}
+
+static void perf_close_events(PerfState* ps) {
+    for (int k = PERF_EVENTS - 1; k >= 0; k--) {
+        if (ps->fds[k] >= 0) close(ps->fds[k]);
+        ps->fds[k] = -1;
+    }
+    ps->leader = -1;
+}
+
+static void perf_read_events(PerfState* ps, uint64_t* now) {
+    uint64_t buf[1 + PERF_EVENTS]; // 组读出格式：个数，随后按打开顺序的各计数值
+    memset(now, 0, PERF_EVENTS * sizeof(uint64_t));
+    if (ps->leader < 0 || read(ps->leader, buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t)) return;
+    for (int k = 0; k < PERF_EVENTS; k++) {
+        if (ps->slot[k] >= 0 && (uint64_t)ps->slot[k] < buf[0]) now[k] = buf[1 + ps->slot[k]];
+    }
+}
+#else
+static void perf_open_events(PerfState* ps) {
+    ps->leader = -1;
+    ps->opened = 0;
+    for (int k = 0; k < PERF_EVENTS; k++) {
+        ps->fds[k] = -1;
+        ps->slot[k] = -1;
+    }
+}
+
+static void perf_close_events(PerfState* ps) {
+    (void)ps;
+}
+
+static void perf_read_events(PerfState* ps, uint64_t* now) {
+    (void)ps;
+    memset(now, 0, PERF_EVENTS * sizeof(uint64_t));
+}
+#endif
+
+int knapsack_perf_enable(int on) {
+    PerfState* ps = &g_perf;
+    if (on && !ps->enabled) {
+        perf_open_events(ps);
+        ps->enabled = 1;
+        ps->ready = 1;
+    } else if (!on && ps->enabled) {
+        perf_close_events(ps);
+        ps->enabled = 0;
+    }
+    return ps->enabled ? ps->opened : 0;
+}
+
+void knapsack_perf_reset(void) {
+    memset(g_perf.total, 0, sizeof(g_perf.total));
+    memset(g_perf.total_ns, 0, sizeof(g_perf.total_ns));
+    memset(g_perf.calls, 0, sizeof(g_perf.calls));
+}
+
+void knapsack_perf_read(KnapsackPhase phase, KnapsackPerfCounters* out) {
+    const PerfState* ps = &g_perf;
+    long long* fields[PERF_EVENTS] = {&out->cycles, &out->instructions, &out->cache_misses, &out->branch_misses};
+    for (int k = 0; k < PERF_EVENTS; k++) *fields[k] = ps->ready && ps->slot[k] >= 0 ? ps->total[phase][k] : -1;
+    out->ns = ps->total_ns[phase];
+    out->calls = ps->calls[phase];
+}
+
+const char* knapsack_perf_phase_name(KnapsackPhase phase) {
+    static const char* names[KS_PHASE_COUNT] = {"dp_setup", "dp_fill", "dp_reconstruct", "greedy_sort", "greedy_fill"};
+    return phase >= 0 && phase < KS_PHASE_COUNT ? names[phase] : "";
+}
+
+// 阶段边界：phase 为 -1 表示开始计时（只记下读数），否则把上一次边界到现在的差值记到 phase
+static void perf_mark(int phase) {
+    PerfState* ps = &g_perf;
+    if (!ps->enabled) return;
+    uint64_t now[PERF_EVENTS];
+    perf_read_events(ps, now);
+    uint64_t now_ns = knapsack_now_ns();
+    if (phase >= 0) {
+        for (int k = 0; k < PERF_EVENTS; k++) ps->total[phase][k] += (long long)(now[k] - ps->last[k]);
+        ps->total_ns[phase] += (long long)(now_ns - ps->last_ns);
+        ps->calls[phase]++;
+    }
+    memcpy(ps->last, now, sizeof(now));
+    ps->last_ns = now_ns;
+}
+
+// 蛮力法
+void brute_force(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int best_combo = 0;
+    double best_value = 0;
+    for (int i = 0; i < (1 << n); i++) {
+        double total_weight = 0, total_value = 0;
+        for (int j = 0; j < n; j++) {
+            if (i & (1 << j)) {
+                total_weight += items[j].weight;
+                total_value += items[j].value;
+            }
+        }
+        if (total_weight <= capacity && total_value > best_value) {
+            best_value = total_value;
+            best_combo = i;
+        }
+    }
+    *max_value = best_value;
+    for (int j = 0; j < n; j++) {
+        selected[j] = (best_combo & (1 << j)) ? 1 : 0;
+    }
+}
+
+// 折半搜索（Meet in the middle）：前后两半各按格雷码枚举子集（相邻子集只差一个物品，O(1) 更新），
+// 后一半按重量做支配过滤（重量增加时只保留价值更大的子集），前一半的每个子集查找剩余容量内后一半的最优子集。
+// 重量、价值按 ×100 转成整数（与 dynamic_programming 的精度一致），格雷码的加减不会累积浮点误差。
+// 容量（×100）小于后一半子集数时，直接按重量建表并求前缀最大值，查询 O(1)；否则排序后二分查找
+
+typedef struct {
+    long long weight;
+    long long value;
+    uint32_t mask;    // 后一半中选中的物品
+} MitmEntry;
+
+static int mitm_cmp(const void* a, const void* b) {
+    const MitmEntry* x = (const MitmEntry*)a;
+    const MitmEntry* y = (const MitmEntry*)b;
+    if (x->weight != y->weight) return x->weight < y->weight ? -1 : 1;
+    return 0;
+}
+
+// 格雷码枚举的下一步：第 k 个子集与第 k-1 个只差第 ctz(k) 个物品
+#define MITM_GRAY_STEP(k, gray, w, v, iw, iv) do {              \
+        int bit_ = __builtin_ctzll(k);                          \
+        (gray) ^= (uint64_t)1 << bit_;                          \
+        if (((gray) >> bit_) & 1) {                             \
+            (w) += (iw)[bit_];                                  \
+            (v) += (iv)[bit_];                                  \
+        } else {                                                \
+            (w) -= (iw)[bit_];                                  \
+            (v) -= (iv)[bit_];                                  \
+        }                                                       \
+    } while (0)
+
+void meet_in_middle(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int scale = 100;
+    long long int_capacity = (long long)(capacity * scale + 0.5);
+    *max_value = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    if (n > MITM_MAX_ITEMS) {
+        knapsack_last_status = KS_STATUS_TRUNCATED;
+        n = MITM_MAX_ITEMS;
+    }
+    int nb = n / 2;     // 后一半：枚举后做支配过滤
+    int na = n - nb;    // 前一半：边枚举边查询
+    long long* iw = (long long*)scratch_malloc(n * sizeof(long long));
+    long long* iv = (long long*)scratch_malloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++) {
+        iw[i] = (long long)(items[i].weight * scale + 0.5);
+        iv[i] = (long long)(items[i].value * scale + 0.5);
+    }
+    const long long* bw = iw + na;
+    const long long* bv = iv + na;
+    uint64_t count_b = (uint64_t)1 << nb;
+    int dense = (uint64_t)int_capacity < count_b;
+
+    // 后一半的支配过滤结果：稠密表 table_v/table_m（下标为重量），或按重量排好序的 list
+    long long* table_v = NULL;
+    uint32_t* table_m = NULL;
+    MitmEntry* list = NULL;
+    if (dense) {
+        table_v = (long long*)scratch_malloc((int_capacity + 1) * sizeof(long long));
+        table_m = (uint32_t*)scratch_malloc((int_capacity + 1) * sizeof(uint32_t));
+    } else {
+        list = (MitmEntry*)scratch_malloc(count_b * sizeof(MitmEntry));
+    }
+    if (dense ? (!table_v || !table_m) : !list) {
+        knapsack_last_status = KS_STATUS_NO_MEMORY;
+        scratch_free(table_v);
+        scratch_free(table_m);
+        scratch_free(list);
+        scratch_free(iw);
+        scratch_free(iv);
+        return;
+    }
+
+    uint64_t kept = 0;
+    uint64_t gray = 0;
+    long long w = 0, v = 0;
+    if (dense) {
+        for (long long c = 0; c <= int_capacity; c++) table_v[c] = -1;
+        table_v[0] = 0;
+        table_m[0] = 0;
+        for (uint64_t k = 1; k < count_b; k++) {
+            MITM_GRAY_STEP(k, gray, w, v, bw, bv);
+            if (w <= int_capacity && v > table_v[w]) {
+                table_v[w] = v;
+                table_m[w] = (uint32_t)gray;
+            }
+        }
+        // 前缀最大值：table_v[c] 变为重量不超过 c 的最优价值
+        for (long long c = 1; c <= int_capacity; c++) {
+            if (table_v[c] <= table_v[c - 1]) {
+                table_v[c] = table_v[c - 1];
+                table_m[c] = table_m[c - 1];
+            }
+        }
+    } else {
+        list[0].weight = 0;
+        list[0].value = 0;
+        list[0].mask = 0;
+        uint64_t size = 1;
+        for (uint64_t k = 1; k < count_b; k++) {
+            MITM_GRAY_STEP(k, gray, w, v, bw, bv);
+            if (w <= int_capacity) {
+                list[size].weight = w;
+                list[size].value = v;
+                list[size].mask = (uint32_t)gray;
+                size++;
+            }
+        }
+        // 按重量排序后只保留价值比所有更轻子集都大的，剩下的价值随重量严格递增
+        qsort(list, size, sizeof(MitmEntry), mitm_cmp);
+        for (uint64_t i = 0; i < size; i++) {
+            if (kept == 0 || list[i].value > list[kept - 1].value) list[kept++] = list[i];
+        }
+    }
+
+    // 枚举前一半，查找剩余容量内后一半的最优子集
+    long long best = -1;
+    uint64_t best_a = 0;
+    uint32_t best_b = 0;
+    uint64_t count_a = (uint64_t)1 << na;
+    gray = 0;
+    w = 0;
+    v = 0;
+    for (uint64_t k = 0; k < count_a; k++) {
+        if (k > 0) MITM_GRAY_STEP(k, gray, w, v, iw, iv);
+        if (w > int_capacity) continue;
+        long long remain = int_capacity - w;
+        long long part_v;
+        uint32_t part_m;
+        if (dense) {
+            part_v = table_v[remain];
+            part_m = table_m[remain];
+        } else {
+            uint64_t lo = 0, hi = kept; // 第一个重量 > remain 的位置；空集重量为0，lo 至少为 1
+            while (lo < hi) {
+                uint64_t mid = (lo + hi) / 2;
+                if (list[mid].weight <= remain) lo = mid + 1;
+                else hi = mid;
+            }
+            part_v = list[lo - 1].value;
+            part_m = list[lo - 1].mask;
+        }
+        if (v + part_v > best) {
+            best = v + part_v;
+            best_a = gray;
+            best_b = part_m;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        int take = i < na ? (int)((best_a >> i) & 1) : (int)((best_b >> (i - na)) & 1);
+        selected[i] = take;
+        if (take) *max_value += items[i].value;
+    }
+    scratch_free(table_v);
+    scratch_free(table_m);
+    scratch_free(list);
+    scratch_free(iw);
+    scratch_free(iv);
+}
+
+// 蛮力法（格雷码 + 多线程）：按格雷码顺序枚举子集，相邻子集只差一个物品，每步 O(1) 更新；
+// 子集编号空间平均分给各线程，各线程记录自己的最优解，最后归约。
+// 使用64位掩码，重量、价值与折半搜索一样按 ×100 转成整数
+
+typedef struct {
+    const long long* iw;
+    const long long* iv;
+    int n;
+    long long capacity;
+    uint64_t begin, end;  // 负责的格雷码序号区间 [begin, end)
+    long long best_value;
+    uint64_t best_mask;
+} BfGrayTask;
+
+static void* bf_gray_worker(void* arg) {
+    BfGrayTask* task = (BfGrayTask*)arg;
+    uint64_t gray = task->begin ^ (task->begin >> 1);
+    long long w = 0, v = 0;
+    for (int j = 0; j < task->n; j++) {
+        if ((gray >> j) & 1) {
+            w += task->iw[j];
+            v += task->iv[j];
+        }
+    }
+    long long best = -1;
+    uint64_t best_mask = 0;
+    for (uint64_t k = task->begin; k < task->end; k++) {
+        if (k > task->begin) MITM_GRAY_STEP(k, gray, w, v, task->iw, task->iv);
+        if (w <= task->capacity && v > best) {
+            best = v;
+            best_mask = gray;
+        }
+    }
+    task->best_value = best;
+    task->best_mask = best_mask;
+    return NULL;
+}
+
+void brute_force_gray(Item* items, int n, double capacity, int* selected, double* max_value, int threads) {
+    int scale = 100;
+    long long int_capacity = (long long)(capacity * scale + 0.5);
+    *max_value = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    if (n > BF_GRAY_MAX_ITEMS) {
+        knapsack_last_status = KS_STATUS_TRUNCATED;
+        n = BF_GRAY_MAX_ITEMS;
+    }
+    uint64_t total = (uint64_t)1 << n;
+    if (threads < 1) threads = 1;
+    if ((uint64_t)threads > total) threads = (int)total;
+    long long* iw = (long long*)scratch_malloc(n * sizeof(long long));
+    long long* iv = (long long*)scratch_malloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++) {
+        iw[i] = (long long)(items[i].weight * scale + 0.5);
+        iv[i] = (long long)(items[i].value * scale + 0.5);
+    }
+
+    BfGrayTask* tasks = (BfGrayTask*)scratch_malloc(threads * sizeof(BfGrayTask));
+    pthread_t* tids = (pthread_t*)scratch_malloc(threads * sizeof(pthread_t));
+    for (int t = 0; t < threads; t++) {
+        tasks[t].iw = iw;
+        tasks[t].iv = iv;
+        tasks[t].n = n;
+        tasks[t].capacity = int_capacity;
+        tasks[t].begin = total / threads * t;
+        tasks[t].end = t == threads - 1 ? total : total / threads * (t + 1);
+    }
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&tids[t], NULL, bf_gray_worker, &tasks[t]);
+    }
+    bf_gray_worker(&tasks[0]);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    int best_t = 0;
+    for (int t = 1; t < threads; t++) {
+        if (tasks[t].best_value > tasks[best_t].best_value) best_t = t;
+    }
+    for (int j = 0; j < n; j++) {
+        selected[j] = (int)((tasks[best_t].best_mask >> j) & 1);
+        if (selected[j]) *max_value += items[j].value;
+    }
+    scratch_free(tasks);
+    scratch_free(tids);
+    scratch_free(iw);
+    scratch_free(iv);
+}
+
+// 回溯法
+void backtrack(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
+               double* max_value, int* curr_selected, int* best_selected) {
+    if (idx == n) {
+        if (curr_value > *max_value) {
+            *max_value = curr_value;
+            memcpy(best_selected, curr_selected, n * sizeof(int));
+        }
+        return;
+    }
+    // 不选当前物品
+    curr_selected[idx] = 0;
+    backtrack(items, n, capacity, idx + 1, curr_weight, curr_value, max_value, curr_selected, best_selected);
+    // 选当前物品（如果重量允许）
+    if (curr_weight + items[idx].weight <= capacity) {
+        curr_selected[idx] = 1;
+        backtrack(items, n, capacity, idx + 1, curr_weight + items[idx].weight,
+                  curr_value + items[idx].value, max_value, curr_selected, best_selected);
+    }
+}
+
+// 回溯法（剪枝：若当前重量+剩余物品最大价值<=已知最优，则剪枝）
+void backtrack_prune(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
+                     double* max_value, int* curr_selected, int* best_selected, double remain_value) {
+    if (idx == n) {
+        if (curr_value > *max_value) {
+            *max_value = curr_value;
+            memcpy(best_selected, curr_selected, n * sizeof(int));
+        }
+        return;
+    }
+    // 剪枝：如果当前价值+剩余最大价值<=已知最优，则不再递归
+    if (curr_value + remain_value <= *max_value) return;
+
+    // 不选当前物品
+    curr_selected[idx] = 0;
+    backtrack_prune(items, n, capacity, idx + 1, curr_weight, curr_value, max_value, curr_selected, best_selected, remain_value - items[idx].value);
+
+    // 选当前物品（如果重量允许）
+    if (curr_weight + items[idx].weight <= capacity) {
+        curr_selected[idx] = 1;
+        backtrack_prune(items, n, capacity, idx + 1, curr_weight + items[idx].weight,
+                        curr_value + items[idx].value, max_value, curr_selected, best_selected, remain_value - items[idx].value);
+    }
+}
+
+// 回溯法（迭代版）：显式栈代替递归，最优选择用64位字的位集保存，重量、价值拆成独立数组。
+// 叶子按与 backtrack()/backtrack_prune() 相同的顺序访问（"不选"优先，即按选择向量的字典序），
+// 但整条"不选"链一步走完：栈里只记录选中的物品及选中后的累计重量/价值，累加顺序与递归版一致；
+// 当前选择即栈中的物品，只在找到更优解时写入最优位集。
+// prune 为 1 时使用与 backtrack_prune() 相同的剪枝（当前价值 + 剩余物品总价值 <= 已知最优）
+void backtrack_iterative(Item* items, int n, double capacity, int* selected, double* max_value, int prune) {
+    size_t words = ((size_t)n + 63) / 64;
+    double* weight = (double*)scratch_malloc((n + 1) * sizeof(double));
+    double* value = (double*)scratch_malloc((n + 1) * sizeof(double));
+    double* remain = (double*)scratch_malloc((n + 1) * sizeof(double)); // remain[i] 为第 i 个及之后物品的总价值
+    int* stack_pos = (int*)scratch_malloc((n + 1) * sizeof(int));        // 选中物品的下标（递增）
+    double* stack_w = (double*)scratch_malloc((n + 1) * sizeof(double)); // 选中该物品后的累计重量
+    double* stack_v = (double*)scratch_malloc((n + 1) * sizeof(double)); // 选中该物品后的累计价值
+    uint64_t* best = (uint64_t*)scratch_calloc(words + 1, sizeof(uint64_t));
+    for (int i = 0; i < n; i++) {
+        weight[i] = items[i].weight;
+        value[i] = items[i].value;
+    }
+    remain[n] = 0;
+    for (int i = n - 1; i >= 0; i--) remain[i] = remain[i + 1] + value[i];
+
+    double best_value = 0;
+    int top = 0;   // 栈中元素个数
+    int depth = 0; // 刚进入的结点深度
+    while (1) {
+        double cw = top > 0 ? stack_w[top - 1] : 0;
+        double cv = top > 0 ? stack_v[top - 1] : 0;
+        // 沿"不选"链下行：价值不变而剩余价值递减，剪枝条件一旦成立，更深的结点也成立，二分找第一个被剪的深度
+        int limit = n;
+        if (prune) {
+            int lo = depth, hi = n;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (cv + remain[mid] <= best_value) hi = mid;
+                else lo = mid + 1;
+            }
+            limit = lo;
+        }
+        if (limit == n && cv > best_value) {
+            best_value = cv;
+            memset(best, 0, words * sizeof(uint64_t));
+            for (int t = 0; t < top; t++) best[stack_pos[t] >> 6] |= (uint64_t)1 << (stack_pos[t] & 63);
+        }
+        // 回溯：从 limit-1 往前，撤销已选的物品，直到找到一个还没尝试"选"且放得下的物品
+        int j = limit - 1;
+        for (; j >= 0; j--) {
+            if (top > 0 && stack_pos[top - 1] == j) {
+                top--;
+                cw = top > 0 ? stack_w[top - 1] : 0;
+                cv = top > 0 ? stack_v[top - 1] : 0;
+            } else if (cw + weight[j] <= capacity) {
+                stack_pos[top] = j;
+                stack_w[top] = cw + weight[j];
+                stack_v[top] = cv + value[j];
+                top++;
+                break;
+            }
+        }
+        if (j < 0) break;
+        depth = j + 1;
+    }
+
+    *max_value = best_value;
+    for (int i = 0; i < n; i++) {
+        selected[i] = (int)((best[i >> 6] >> (i & 63)) & 1);
+    }
+    scratch_free(weight);
+    scratch_free(value);
+    scratch_free(remain);
+    scratch_free(stack_pos);
+    scratch_free(stack_w);
+    scratch_free(stack_v);
+    scratch_free(best);
+}
+
+// 动态规划法（整数化处理）
+void dynamic_programming(Item* items, int n, double capacity, int* selected, double* max_value) {
+    perf_mark(-1);
+    int scale = 100; // 精度：保留两位小数
+    int int_capacity = (int)(capacity * scale + 0.5);
+    int* int_weight = (int*)scratch_malloc(n * sizeof(int));
+    double* value = (double*)scratch_malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        int_weight[i] = (int)(items[i].weight * scale + 0.5);
+        value[i] = items[i].value;
+    }
+
+    double** dp = (double**)scratch_malloc((n + 1) * sizeof(double*));
+    int** keep = (int**)scratch_malloc((n + 1) * sizeof(int*));
+    for (int i = 0; i <= n; i++) {
+        dp[i] = (double*)scratch_calloc(int_capacity + 1, sizeof(double));
+        keep[i] = (int*)scratch_calloc(int_capacity + 1, sizeof(int));
+    }
+    perf_mark(KS_PHASE_DP_SETUP);
+
+    for (int i = 1; i <= n; i++) {
+        for (int w = 0; w <= int_capacity; w++) {
+            if (int_weight[i-1] <= w) {
+                double val_without = dp[i-1][w];
+                double val_with = dp[i-1][w - int_weight[i-1]] + value[i-1];
+                if (val_with > val_without) {
+                    dp[i][w] = val_with;
+                    keep[i][w] = 1;
+                } else {
+                    dp[i][w] = val_without;
+                }
+            } else {
+                dp[i][w] = dp[i-1][w];
+            }
+        }
+    }
+    perf_mark(KS_PHASE_DP_FILL);
+
+    *max_value = dp[n][int_capacity];
+    int w = int_capacity;
+    for (int i = n; i > 0; i--) {
+        if (keep[i][w]) {
+            selected[i-1] = 1;
+            w -= int_weight[i-1];
+        }
+    }
+
+    for (int i = 0; i <= n; i++) {
+        scratch_free(dp[i]);
+        scratch_free(keep[i]);
+    }
+    scratch_free(dp);
+    scratch_free(keep);
+    scratch_free(int_weight);
+    scratch_free(value);
+    perf_mark(KS_PHASE_DP_RECONSTRUCT);
+}
+
+// ---------------- 滚动数组动态规划（低内存） ----------------
+// 只保留两行价值数组，选择信息用位压缩矩阵记录（n*W/8 字节）；
+// 位矩阵超过 DP_BITSET_LIMIT 时改用分治（Hirschberg）重建，峰值内存为 O(W)
+#define DP_BITSET_LIMIT ((size_t)64 << 20) // 位压缩选择矩阵的内存上限：64MB
+#define DP_HS_BASE_ITEMS 128              // 分治时物品数不超过该值的子问题直接用位矩阵求解
+
+// DP行更新内核：dst[j] = max(same[j], shift[j] + value)
+// 选中（shift[j] + value 更大）时把 keep 位图的第 bit + j 位置1，keep 为 NULL 时不记录
+static void dp_kernel_scalar(const double* same, const double* shift, double* dst, int count,
+                             double value, uint64_t* keep, size_t bit) {
+    for (int j = 0; j < count; j++) {
+        double val_without = same[j];
+        double val_with = shift[j] + value;
+        if (val_with > val_without) {
+            dst[j] = val_with;
+            if (keep) keep[(bit + j) >> 6] |= (uint64_t)1 << ((bit + j) & 63);
+        } else {
+            dst[j] = val_without;
+        }
+    }
+}
+
+#ifdef DP_X86_SIMD
+// 把 lanes 个比较结果（mask 的低位）写入位图的 pos 位置，可能跨越两个字
+static inline void dp_keep_store(uint64_t* keep, size_t pos, unsigned mask, int lanes) {
+    if (!mask) return;
+    size_t word = pos >> 6;
+    unsigned off = (unsigned)(pos & 63);
+    keep[word] |= (uint64_t)mask << off;
+    if (off + lanes > 64) keep[word + 1] |= (uint64_t)mask >> (64 - off);
+}
+
+// SSE2 内核：每次处理2个容量，用 max 代替分支（maxpd(a, b) 即 a > b ? a : b，与标量比较语义一致），
+// 比较掩码压缩成选择位
+__attribute__((target("sse2")))
+static void dp_kernel_sse2(const double* same, const double* shift, double* dst, int count,
+                           double value, uint64_t* keep, size_t bit) {
+    __m128d v = _mm_set1_pd(value);
+    int j = 0;
+    for (; j + 2 <= count; j += 2) {
+        __m128d without = _mm_loadu_pd(same + j);
+        __m128d with = _mm_add_pd(_mm_loadu_pd(shift + j), v);
+        __m128d take = _mm_cmpgt_pd(with, without);
+        _mm_storeu_pd(dst + j, _mm_max_pd(with, without));
+        if (keep) dp_keep_store(keep, bit + j, (unsigned)_mm_movemask_pd(take), 2);
+    }
+    if (j < count) dp_kernel_scalar(same + j, shift + j, dst + j, count - j, value, keep, bit + j);
+}
+
+// AVX 内核：每次处理4个容量
+__attribute__((target("avx")))
+static void dp_kernel_avx(const double* same, const double* shift, double* dst, int count,
+                          double value, uint64_t* keep, size_t bit) {
+    __m256d v = _mm256_set1_pd(value);
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        __m256d without = _mm256_loadu_pd(same + j);
+        __m256d with = _mm256_add_pd(_mm256_loadu_pd(shift + j), v);
+        __m256d take = _mm256_cmp_pd(with, without, _CMP_GT_OQ);
+        _mm256_storeu_pd(dst + j, _mm256_max_pd(with, without));
+        if (keep) dp_keep_store(keep, bit + j, (unsigned)_mm256_movemask_pd(take), 4);
+    }
+    if (j < count) dp_kernel_scalar(same + j, shift + j, dst + j, count - j, value, keep, bit + j);
+}
+#endif
+
+typedef void (*DpKernelFn)(const double* same, const double* shift, double* dst, int count,
+                           double value, uint64_t* keep, size_t bit);
+
+static DpKernelFn dp_kernel = NULL; // 当前使用的内核，首次使用时按CPU能力选择
+static int g_dp_simd_level = 0;     // 0:标量 1:SSE2 2:AVX 3:AVX2（double 行仍用 AVX 内核，整数DP用 AVX2 内核）
+
+// 设置DP内核：-1 自动检测，0 标量，1 SSE2，2 AVX，3 AVX2（CPU不支持时自动降级）
+void dp_set_simd(int level) {
+    int best = 0;
+#ifdef DP_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) best = 1;
+    if (__builtin_cpu_supports("avx")) best = 2;
+    if (best == 2 && __builtin_cpu_supports("avx2")) best = 3;
+#endif
+    if (level < 0 || level > best) level = best;
+    g_dp_simd_level = level;
+    dp_kernel = dp_kernel_scalar;
+#ifdef DP_X86_SIMD
+    if (level == 1) dp_kernel = dp_kernel_sse2;
+    if (level >= 2) dp_kernel = dp_kernel_avx;
+#endif
+}
+
+// 首次使用时按CPU能力选择内核；多个线程（如批量求解的工作线程）可能同时走到这里，用 pthread_once 保证只初始化一次
+static pthread_once_t dp_simd_once = PTHREAD_ONCE_INIT;
+
+static void dp_simd_default(void) {
+    if (!dp_kernel) dp_set_simd(-1); // 调用者事先用 dp_set_simd 指定过时保持不变
+}
+
+static void dp_simd_ensure(void) {
+    pthread_once(&dp_simd_once, dp_simd_default);
+}
+
+const char* dp_simd_name(void) {
+    dp_simd_ensure();
+    static const char* names[] = {"标量", "SSE2", "AVX", "AVX2"};
+    return names[g_dp_simd_level];
+}
+
+// 用一个物品把 prev 行的容量区间 [lo, hi) 推进到 cur 行，keep 为该物品对应的位图行
+static void dp_row_update(const double* prev, double* cur, int lo, int hi, int weight, double value, uint64_t* keep) {
+    int split = weight < lo ? lo : (weight > hi ? hi : weight);
+    if (split > lo) memcpy(cur + lo, prev + lo, (split - lo) * sizeof(double));
+    if (split < hi) {
+        dp_kernel(prev + split, prev + split - weight, cur + split, hi - split, value, keep, (size_t)split);
+    }
+}
+
+// 时间分块填表：一次把一组物品（K 个）推进过一个容量窗口 [lo, lo+T)，窗口从小到大扫过整行，
+// 这样每 K 个物品只读写一遍主行，而不是每个物品一遍。第 k 个物品在窗口内要用第 k-1 层 [lo - w_k, hi) 的值，
+// 比 lo 小的部分在前面的窗口里已经算好，所以中间层只需保留最近 T + max(w) 个容量，
+// 放在长度为 2 的幂的环形缓冲区里，总量不超过 DP_BLOCK_BUDGET（常驻 L2）
+#define DP_BLOCK_WINDOW 2048              // 容量窗口长度（double 个数，16KB）
+#define DP_BLOCK_BUDGET ((size_t)1 << 20) // 中间层环形缓冲区的总字节数上限
+#define DP_BLOCK_MAX_ITEMS 16             // 每组最多推进的物品数
+#define DP_BLOCK_AUTO_BYTES ((size_t)4 << 20) // 自动模式下两行超过该大小才分块（再小时两行加环形缓冲区会挤出 L2，反而变慢）
+
+static int g_dp_block_items = -1; // -1 自动，0 关闭，k>0 每组最多 k 个物品
+
+// 设置DP时间分块：-1 自动（两行超过 DP_BLOCK_AUTO_BYTES 时启用），0 关闭，k>0 强制启用且每组最多 k 个物品
+void dp_set_blocking(int items) {
+    g_dp_block_items = items > DP_BLOCK_MAX_ITEMS ? DP_BLOCK_MAX_ITEMS : items;
+}
+
+// 分块时的一层：完整行（mask < 0）或环形缓冲区（下标按 mask 回绕）
+typedef struct {
+    double* base;
+    int mask;
+} DpLevel;
+
+// 从容量 pos 开始最多 len 个元素中不回绕的部分，返回其起始地址，*run 为长度
+static inline double* dp_level_at(const DpLevel* l, int pos, int len, int* run) {
+    if (l->mask < 0) {
+        *run = len;
+        return l->base + pos;
+    }
+    int off = pos & l->mask;
+    *run = len < l->mask + 1 - off ? len : l->mask + 1 - off;
+    return l->base + off;
+}
+
+// 与 dp_row_update 相同，只是源层和目标层可能是环形缓冲区，遇到回绕处拆成几段调用内核
+static void dp_level_update(const DpLevel* src, const DpLevel* dst, int lo, int hi, int weight, double value,
+                            uint64_t* keep) {
+    int split = weight < lo ? lo : (weight > hi ? hi : weight);
+    for (int c = lo; c < split;) {
+        int len, run;
+        const double* same = dp_level_at(src, c, split - c, &len);
+        double* out = dp_level_at(dst, c, len, &run);
+        memcpy(out, same, run * sizeof(double));
+        c += run;
+    }
+    for (int c = split; c < hi;) {
+        int len, run;
+        const double* same = dp_level_at(src, c, hi - c, &len);
+        const double* shift = dp_level_at(src, c - weight, len, &run);
+        double* out = dp_level_at(dst, c, run, &len);
+        dp_kernel(same, shift, out, len, value, keep, (size_t)c);
+        c += len;
+    }
+}
+
+// 单线程时间分块填表，ring 为 DP_BLOCK_BUDGET 字节的缓冲区，limit 为每组最多的物品数；返回最后一行
+static double* dp_fill_blocked(const int* weights, const double* values, int count, int cap,
+                               double* row_a, double* row_b, uint64_t* keep, size_t words, double* ring, int limit) {
+    DpLevel levels[DP_BLOCK_MAX_ITEMS + 1];
+    double* prev = row_a;
+    double* cur = row_b;
+    for (int i = 0; i < count;) {
+        // 组内每多一个物品就多一层中间结果，按组内最大重量决定环长，超出预算就截止
+        int k = 1;
+        int ring_len = 0;
+        int max_w = weights[i] < cap ? weights[i] : cap;
+        while (k < limit && i + k < count) {
+            int w = weights[i + k] < cap ? weights[i + k] : cap;
+            if (w < max_w) w = max_w;
+            int len = 1;
+            while (len < DP_BLOCK_WINDOW + w + 1) len <<= 1;
+            if ((size_t)k * len * sizeof(double) > DP_BLOCK_BUDGET) break;
+            max_w = w;
+            ring_len = len;
+            k++;
+        }
+        levels[0].base = prev;
+        levels[0].mask = -1;
+        for (int j = 1; j < k; j++) {
+            levels[j].base = ring + (size_t)(j - 1) * ring_len;
+            levels[j].mask = ring_len - 1;
+        }
+        levels[k].base = cur;
+        levels[k].mask = -1;
+        for (int lo = 0; lo <= cap; lo += DP_BLOCK_WINDOW) {
+            int hi = lo + DP_BLOCK_WINDOW < cap + 1 ? lo + DP_BLOCK_WINDOW : cap + 1;
+            for (int j = 0; j < k; j++) {
+                dp_level_update(&levels[j], &levels[j + 1], lo, hi, weights[i + j], values[i + j],
+                                keep ? keep + (size_t)(i + j) * words : NULL);
+            }
+        }
+        double* tmp = prev;
+        prev = cur;
+        cur = tmp;
+        i += k;
+    }
+    return prev;
+}
+
+// 并行填表：每个线程负责容量轴上的一段，每放入一个物品后在屏障处同步一次
+#define DP_PARALLEL_MIN_SLICE 4096 // 每个线程至少分到的容量数，太小时减少线程数
+
+typedef struct {
+    const int* weights;
+    const double* values;
+    int count;
+    double* rows[2];   // 交替作为 prev/cur
+    uint64_t* keep;
+    size_t words;
+    pthread_barrier_t barrier;
+} DpParallelJob;
+
+typedef struct {
+    DpParallelJob* job;
+    int lo, hi;        // 负责的容量区间 [lo, hi)，边界按64对齐，保证各线程写不同的位图字
+} DpParallelSlice;
+
+static void* dp_parallel_worker(void* arg) {
+    DpParallelSlice* slice = (DpParallelSlice*)arg;
+    DpParallelJob* job = slice->job;
+    for (int i = 0; i < job->count; i++) {
+        const double* prev = job->rows[i & 1];
+        double* cur = job->rows[(i + 1) & 1];
+        dp_row_update(prev, cur, slice->lo, slice->hi, job->weights[i], job->values[i],
+                      job->keep ? job->keep + (size_t)i * job->words : NULL);
+        pthread_barrier_wait(&job->barrier);
+    }
+    return NULL;
+}
+
+// 依次放入 count 个物品，返回最后一行（容量 0..cap 的最优值）
+// row_a/row_b 为两块长度 cap+1 的缓冲区；keep 非空时第 i 个物品的位图行为 keep + i*words
+static double* dp_fill_rows(const int* weights, const double* values, int count, int cap,
+                            double* row_a, double* row_b, uint64_t* keep, size_t words, int threads) {
+    dp_simd_ensure();
+    memset(row_a, 0, (cap + 1) * sizeof(double));
+    if (threads > (cap + 1) / DP_PARALLEL_MIN_SLICE) threads = (cap + 1) / DP_PARALLEL_MIN_SLICE;
+    if (threads <= 1 || count < 2) {
+        int limit = g_dp_block_items;
+        if (limit < 0) limit = 2 * ((size_t)cap + 1) * sizeof(double) > DP_BLOCK_AUTO_BYTES ? DP_BLOCK_MAX_ITEMS : 0;
+        if (limit > 1 && count > 1) {
+            double* ring = (double*)scratch_malloc(DP_BLOCK_BUDGET);
+            if (ring) {
+                double* last = dp_fill_blocked(weights, values, count, cap, row_a, row_b, keep, words, ring, limit);
+                scratch_free(ring);
+                return last;
+            }
+        }
+        double* prev = row_a;
+        double* cur = row_b;
+        for (int i = 0; i < count; i++) {
+            dp_row_update(prev, cur, 0, cap + 1, weights[i], values[i], keep ? keep + (size_t)i * words : NULL);
+            double* tmp = prev;
+            prev = cur;
+            cur = tmp;
+        }
+        return prev;
+    }
+
+    DpParallelJob job;
+    job.weights = weights;
+    job.values = values;
+    job.count = count;
+    job.rows[0] = row_a;
+    job.rows[1] = row_b;
+    job.keep = keep;
+    job.words = words;
+    pthread_barrier_init(&job.barrier, NULL, threads);
+    DpParallelSlice* slices = (DpParallelSlice*)scratch_malloc(threads * sizeof(DpParallelSlice));
+    pthread_t* tids = (pthread_t*)scratch_malloc(threads * sizeof(pthread_t));
+    int chunk = ((cap + 1) / threads + 63) / 64 * 64;
+    for (int t = 0; t < threads; t++) {
+        slices[t].job = &job;
+        slices[t].lo = t * chunk < cap + 1 ? t * chunk : cap + 1;
+        slices[t].hi = (t == threads - 1 || (t + 1) * chunk > cap + 1) ? cap + 1 : (t + 1) * chunk;
+    }
+    for (int t = 1; t < threads; t++) {
+        pthread_create(&tids[t], NULL, dp_parallel_worker, &slices[t]);
+    }
+    dp_parallel_worker(&slices[0]); // 主线程负责第一段
+    for (int t = 1; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    pthread_barrier_destroy(&job.barrier);
+    scratch_free(tids);
+    scratch_free(slices);
+    return job.rows[count & 1];
+}
+
+// 位压缩选择矩阵求解：keep 至少要有 count*words 个字
+static double dp_solve_bitset(const int* weights, const double* values, int count, int cap,
+                              double* row_a, double* row_b, uint64_t* keep, int* selected, int threads) {
+    size_t words = ((size_t)cap + 64) / 64;
+    memset(keep, 0, (size_t)count * words * sizeof(uint64_t));
+    double* last = dp_fill_rows(weights, values, count, cap, row_a, row_b, keep, words, threads);
+    double best = last[cap];
+    int w = cap;
+    for (int i = count - 1; i >= 0; i--) {
+        if ((keep[(size_t)i * words + (w >> 6)] >> (w & 63)) & 1) {
+            selected[i] = 1;
+            w -= weights[i];
+        } else {
+            selected[i] = 0;
+        }
+    }
+    return best;
+}
+
+// 分治重建所需的缓冲区
+typedef struct {
+    const int* weight;
+    const double* value;
+    double* f;       // 前半段物品的价值行
+    double* f_tmp;
+    double* g;       // 后半段物品的价值行
+    double* g_tmp;
+    uint64_t* keep;  // 基础情形使用的位矩阵（DP_HS_BASE_ITEMS 行）
+    int* selected;
+    int threads;
+} HsContext;
+
+// 求解物品 [lo, hi) 在容量 cap 下的最优选择：前后两半各做一次滚动DP，
+// 找到使 f[c] + g[cap-c] 最大的容量划分 c，再分别递归
+static double dp_hirschberg(HsContext* hs, int lo, int hi, int cap) {
+    int count = hi - lo;
+    if (count <= 0) return 0;
+    if (count <= DP_HS_BASE_ITEMS) {
+        return dp_solve_bitset(hs->weight + lo, hs->value + lo, count, cap, hs->f, hs->f_tmp, hs->keep,
+                               hs->selected + lo, hs->threads);
+    }
+    int mid = lo + count / 2;
+    double* f = dp_fill_rows(hs->weight + lo, hs->value + lo, mid - lo, cap, hs->f, hs->f_tmp, NULL, 0, hs->threads);
+    double* g = dp_fill_rows(hs->weight + mid, hs->value + mid, hi - mid, cap, hs->g, hs->g_tmp, NULL, 0, hs->threads);
+    int best_c = 0;
+    double best = -1;
+    for (int c = 0; c <= cap; c++) {
+        if (f[c] + g[cap - c] > best) {
+            best = f[c] + g[cap - c];
+            best_c = c;
+        }
+    }
+    dp_hirschberg(hs, lo, mid, best_c);
+    dp_hirschberg(hs, mid, hi, cap - best_c);
+    return best;
+}
+
+// 已整数化的物品数组上求解：位矩阵不超过 DP_BITSET_LIMIT 时直接记录选择，否则分治重建。
+// 返回最优值，内存不足时返回 -1
+static double dp_solve_arrays(const int* int_weight, const double* value, int n, int int_capacity,
+                              int* selected, int threads) {
+    double best = -1;
+    size_t row_bytes = ((size_t)int_capacity + 1) * sizeof(double);
+    size_t words = ((size_t)int_capacity + 64) / 64;
+    size_t keep_bytes = (size_t)n * words * sizeof(uint64_t);
+    if (keep_bytes <= DP_BITSET_LIMIT) {
+        double* row_a = (double*)scratch_malloc(row_bytes);
+        double* row_b = (double*)scratch_malloc(row_bytes);
+        uint64_t* keep = (uint64_t*)scratch_malloc(keep_bytes);
+        if (row_a && row_b && keep) {
+            best = dp_solve_bitset(int_weight, value, n, int_capacity, row_a, row_b, keep, selected, threads);
+        }
+        scratch_free(row_a);
+        scratch_free(row_b);
+        scratch_free(keep);
+    } else {
+        HsContext hs;
+        hs.weight = int_weight;
+        hs.value = value;
+        hs.f = (double*)scratch_malloc(row_bytes);
+        hs.f_tmp = (double*)scratch_malloc(row_bytes);
+        hs.g = (double*)scratch_malloc(row_bytes);
+        hs.g_tmp = (double*)scratch_malloc(row_bytes);
+        hs.keep = (uint64_t*)scratch_malloc(DP_HS_BASE_ITEMS * words * sizeof(uint64_t));
+        hs.selected = selected;
+        hs.threads = threads;
+        if (hs.f && hs.f_tmp && hs.g && hs.g_tmp && hs.keep) {
+            best = dp_hirschberg(&hs, 0, n, int_capacity);
+        }
+        scratch_free(hs.f);
+        scratch_free(hs.f_tmp);
+        scratch_free(hs.g);
+        scratch_free(hs.g_tmp);
+        scratch_free(hs.keep);
+    }
+    return best;
+}
+
+// 动态规划法（多线程：滚动数组 + 位压缩/分治重建，容量轴按线程划分）
+void dynamic_programming_parallel(Item* items, int n, double capacity, int* selected, double* max_value, int threads) {
+    int scale = 100; // 精度：保留两位小数，与 dynamic_programming 一致
+    int int_capacity = (int)(capacity * scale + 0.5);
+    *max_value = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    int* int_weight = (int*)scratch_malloc(n * sizeof(int));
+    double* value = (double*)scratch_malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        int_weight[i] = (int)(items[i].weight * scale + 0.5);
+        value[i] = items[i].value;
+    }
+    double best = dp_solve_arrays(int_weight, value, n, int_capacity, selected, threads);
+    if (best < 0) knapsack_last_status = KS_STATUS_NO_MEMORY;
+    else *max_value = best;
+    scratch_free(int_weight);
+    scratch_free(value);
+}
+
+// 动态规划法（滚动数组 + 位压缩/分治重建，单线程）
+void dynamic_programming_rolling(Item* items, int n, double capacity, int* selected, double* max_value) {
+    dynamic_programming_parallel(items, n, capacity, selected, max_value, 1);
+}
+
+// ---------------- 整数定点动态规划 ----------------
+// 价值也按 ×100 取整（数据都是两位小数，取整没有误差），整张表用整数存储，比较没有浮点舍入造成的平局歧义。
+// 元素宽度按全部价值之和决定：放得进 int32 就用 int32，否则用 int64。int32 时一个 AVX2 向量处理 8 个容量
+// （double 只有 4 个），每行的读写量减半。与滚动DP相同，选择信息记在位矩阵里，超过 DP_BITSET_LIMIT 时分治重建
+KS_THREAD_LOCAL int dp_int_last_bits = 0; // 最近一次整数DP使用的元素位数
+
+// 整数DP行更新内核：与 dp_kernel_* 相同，只是元素为 int32 或 int64
+typedef void (*DpIntKernelFn)(const void* same, const void* shift, void* dst, int count,
+                              int64_t value, uint64_t* keep, size_t bit);
+
+static void dpi_kernel_scalar32(const void* same_p, const void* shift_p, void* dst_p, int count,
+                                int64_t value, uint64_t* keep, size_t bit) {
+    const int32_t* same = (const int32_t*)same_p;
+    const int32_t* shift = (const int32_t*)shift_p;
+    int32_t* dst = (int32_t*)dst_p;
+    int32_t v = (int32_t)value;
+    for (int j = 0; j < count; j++) {
+        int32_t val_without = same[j];
+        int32_t val_with = shift[j] + v;
+        if (val_with > val_without) {
+            dst[j] = val_with;
+            if (keep) keep[(bit + j) >> 6] |= (uint64_t)1 << ((bit + j) & 63);
+        } else {
+            dst[j] = val_without;
+        }
+    }
+}
+
+static void dpi_kernel_scalar64(const void* same_p, const void* shift_p, void* dst_p, int count,
+                                int64_t value, uint64_t* keep, size_t bit) {
+    const int64_t* same = (const int64_t*)same_p;
+    const int64_t* shift = (const int64_t*)shift_p;
+    int64_t* dst = (int64_t*)dst_p;
+    for (int j = 0; j < count; j++) {
+        int64_t val_without = same[j];
+        int64_t val_with = shift[j] + value;
+        if (val_with > val_without) {
+            dst[j] = val_with;
+            if (keep) keep[(bit + j) >> 6] |= (uint64_t)1 << ((bit + j) & 63);
+        } else {
+            dst[j] = val_without;
+        }
+    }
+}
+
+#ifdef DP_X86_SIMD
+// SSE2 没有 32 位整数的 max，用比较掩码做选择
+__attribute__((target("sse2")))
+static void dpi_kernel_sse2_32(const void* same_p, const void* shift_p, void* dst_p, int count,
+                               int64_t value, uint64_t* keep, size_t bit) {
+    const int32_t* same = (const int32_t*)same_p;
+    const int32_t* shift = (const int32_t*)shift_p;
+    int32_t* dst = (int32_t*)dst_p;
+    __m128i v = _mm_set1_epi32((int32_t)value);
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        __m128i without = _mm_loadu_si128((const __m128i*)(same + j));
+        __m128i with = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(shift + j)), v);
+        __m128i take = _mm_cmpgt_epi32(with, without);
+        _mm_storeu_si128((__m128i*)(dst + j), _mm_or_si128(_mm_and_si128(take, with), _mm_andnot_si128(take, without)));
+        if (keep) dp_keep_store(keep, bit + j, (unsigned)_mm_movemask_ps(_mm_castsi128_ps(take)), 4);
+    }
+    if (j < count) dpi_kernel_scalar32(same + j, shift + j, dst + j, count - j, value, keep, bit + j);
+}
+
+// AVX2 内核：int32 每次处理 8 个容量
+__attribute__((target("avx2")))
+static void dpi_kernel_avx2_32(const void* same_p, const void* shift_p, void* dst_p, int count,
+                               int64_t value, uint64_t* keep, size_t bit) {
+    const int32_t* same = (const int32_t*)same_p;
+    const int32_t* shift = (const int32_t*)shift_p;
+    int32_t* dst = (int32_t*)dst_p;
+    __m256i v = _mm256_set1_epi32((int32_t)value);
+    int j = 0;
+    for (; j + 8 <= count; j += 8) {
+        __m256i without = _mm256_loadu_si256((const __m256i*)(same + j));
+        __m256i with = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(shift + j)), v);
+        _mm256_storeu_si256((__m256i*)(dst + j), _mm256_max_epi32(with, without));
+        if (keep) {
+            __m256i take = _mm256_cmpgt_epi32(with, without);
+            dp_keep_store(keep, bit + j, (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(take)), 8);
+        }
+    }
+    if (j < count) dpi_kernel_scalar32(same + j, shift + j, dst + j, count - j, value, keep, bit + j);
+}
+
+// AVX2 内核：int64 每次处理 4 个容量
+__attribute__((target("avx2")))
+static void dpi_kernel_avx2_64(const void* same_p, const void* shift_p, void* dst_p, int count,
+                               int64_t value, uint64_t* keep, size_t bit) {
+    const int64_t* same = (const int64_t*)same_p;
+    const int64_t* shift = (const int64_t*)shift_p;
+    int64_t* dst = (int64_t*)dst_p;
+    __m256i v = _mm256_set1_epi64x(value);
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        __m256i without = _mm256_loadu_si256((const __m256i*)(same + j));
+        __m256i with = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(shift + j)), v);
+        __m256i take = _mm256_cmpgt_epi64(with, without);
+        _mm256_storeu_si256((__m256i*)(dst + j), _mm256_blendv_epi8(without, with, take));
+        if (keep) dp_keep_store(keep, bit + j, (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(take)), 4);
+    }
+    if (j < count) dpi_kernel_scalar64(same + j, shift + j, dst + j, count - j, value, keep, bit + j);
+}
+#endif
+
+typedef struct {
+    size_t elem;          // 元素字节数：4 或 8
+    DpIntKernelFn kernel;
+} DpIntEngine;
+
+// 按当前 DP 内核级别（dp_set_simd）选择整数内核
+static void dpi_engine_init(DpIntEngine* e, int bits) {
+    dp_simd_ensure();
+    e->elem = bits == 32 ? sizeof(int32_t) : sizeof(int64_t);
+    e->kernel = bits == 32 ? dpi_kernel_scalar32 : dpi_kernel_scalar64;
+#ifdef DP_X86_SIMD
+    if (bits == 32 && g_dp_simd_level >= 1) e->kernel = dpi_kernel_sse2_32;
+    if (g_dp_simd_level >= 3) e->kernel = bits == 32 ? dpi_kernel_avx2_32 : dpi_kernel_avx2_64;
+#endif
+}
+
+static inline int64_t dpi_get(const DpIntEngine* e, const char* row, int c) {
+    return e->elem == sizeof(int32_t) ? ((const int32_t*)row)[c] : ((const int64_t*)row)[c];
+}
+
+// 用一个物品把 prev 行（容量 0..cap）推进到 cur 行，keep 为该物品对应的位图行（可为 NULL）
+static void dpi_row_update(const DpIntEngine* e, const char* prev, char* cur, int cap, int weight, int64_t value,
+                           uint64_t* keep) {
+    int split = weight > cap + 1 ? cap + 1 : weight;
+    if (split > 0) memcpy(cur, prev, (size_t)split * e->elem);
+    if (split < cap + 1) {
+        e->kernel(prev + (size_t)split * e->elem, prev, cur + (size_t)split * e->elem, cap + 1 - split, value, keep,
+                  (size_t)split);
+    }
+}
+
+// 依次放入 count 个物品，返回最后一行；与 dp_fill_rows 相同，只是单线程
+static char* dpi_fill_rows(const DpIntEngine* e, const int* weights, const int64_t* values, int count, int cap,
+                           char* row_a, char* row_b, uint64_t* keep, size_t words) {
+    memset(row_a, 0, (size_t)(cap + 1) * e->elem);
+    char* prev = row_a;
+    char* cur = row_b;
+    for (int i = 0; i < count; i++) {
+        dpi_row_update(e, prev, cur, cap, weights[i], values[i], keep ? keep + (size_t)i * words : NULL);
+        char* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+    return prev;
+}
+
+static int64_t dpi_solve_bitset(const DpIntEngine* e, const int* weights, const int64_t* values, int count, int cap,
+                                char* row_a, char* row_b, uint64_t* keep, int* selected) {
+    size_t words = ((size_t)cap + 64) / 64;
+    memset(keep, 0, (size_t)count * words * sizeof(uint64_t));
+    char* last = dpi_fill_rows(e, weights, values, count, cap, row_a, row_b, keep, words);
+    int64_t best = dpi_get(e, last, cap);
+    int w = cap;
+    for (int i = count - 1; i >= 0; i--) {
+        if ((keep[(size_t)i * words + (w >> 6)] >> (w & 63)) & 1) {
+            selected[i] = 1;
+            w -= weights[i];
+        } else {
+            selected[i] = 0;
+        }
+    }
+    return best;
+}
+
+typedef struct {
+    const DpIntEngine* e;
+    const int* weight;
+    const int64_t* value;
+    char* f;
+    char* f_tmp;
+    char* g;
+    char* g_tmp;
+    uint64_t* keep;
+    int* selected;
+} DpiHsContext;
+
+// 与 dp_hirschberg 相同的分治重建
+static int64_t dpi_hirschberg(DpiHsContext* hs, int lo, int hi, int cap) {
+    int count = hi - lo;
+    if (count <= 0) return 0;
+    if (count <= DP_HS_BASE_ITEMS) {
+        return dpi_solve_bitset(hs->e, hs->weight + lo, hs->value + lo, count, cap, hs->f, hs->f_tmp, hs->keep,
+                                hs->selected + lo);
+    }
+    int mid = lo + count / 2;
+    char* f = dpi_fill_rows(hs->e, hs->weight + lo, hs->value + lo, mid - lo, cap, hs->f, hs->f_tmp, NULL, 0);
+    char* g = dpi_fill_rows(hs->e, hs->weight + mid, hs->value + mid, hi - mid, cap, hs->g, hs->g_tmp, NULL, 0);
+    int best_c = 0;
+    int64_t best = -1;
+    for (int c = 0; c <= cap; c++) {
+        int64_t total = dpi_get(hs->e, f, c) + dpi_get(hs->e, g, cap - c);
+        if (total > best) {
+            best = total;
+            best_c = c;
+        }
+    }
+    dpi_hirschberg(hs, lo, mid, best_c);
+    dpi_hirschberg(hs, mid, hi, cap - best_c);
+    return best;
+}
+
+// 动态规划法（整数定点：价值 ×100 存为 int32/int64，滚动数组 + 位压缩/分治重建）
+void dynamic_programming_int(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int scale = 100; // 重量与价值都保留两位小数
+    int int_capacity = (int)(capacity * scale + 0.5);
+    *max_value = 0;
+    dp_int_last_bits = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    int* int_weight = (int*)scratch_malloc(n * sizeof(int));
+    int64_t* int_value = (int64_t*)scratch_malloc(n * sizeof(int64_t));
+    if (!int_weight || !int_value) {
+        scratch_free(int_weight);
+        scratch_free(int_value);
+        knapsack_last_status = KS_STATUS_NO_MEMORY;
+        return;
+    }
+    // 表中任何一格都不超过全部（正）价值之和，按它决定元素宽度；价值为负的物品永远不会被选中，按 0 处理
+    int64_t total = 0;
+    for (int i = 0; i < n; i++) {
+        int_weight[i] = (int)(items[i].weight * scale + 0.5);
+        double v = items[i].value * scale;
+        int_value[i] = v > 0 ? (int64_t)(v + 0.5) : 0;
+        total += int_value[i];
+    }
+    DpIntEngine e;
+    dpi_engine_init(&e, total <= INT32_MAX ? 32 : 64);
+    dp_int_last_bits = (int)(e.elem * 8);
+
+    int64_t best = -1;
+    size_t row_bytes = ((size_t)int_capacity + 1) * e.elem;
+    size_t words = ((size_t)int_capacity + 64) / 64;
+    size_t keep_bytes = (size_t)n * words * sizeof(uint64_t);
+    if (keep_bytes <= DP_BITSET_LIMIT) {
+        char* row_a = (char*)scratch_malloc(row_bytes);
+        char* row_b = (char*)scratch_malloc(row_bytes);
+        uint64_t* keep = (uint64_t*)scratch_malloc(keep_bytes);
+        if (row_a && row_b && keep) {
+            best = dpi_solve_bitset(&e, int_weight, int_value, n, int_capacity, row_a, row_b, keep, selected);
+        }
+        scratch_free(row_a);
+        scratch_free(row_b);
+        scratch_free(keep);
+    } else {
+        DpiHsContext hs;
+        hs.e = &e;
+        hs.weight = int_weight;
+        hs.value = int_value;
+        hs.f = (char*)scratch_malloc(row_bytes);
+        hs.f_tmp = (char*)scratch_malloc(row_bytes);
+        hs.g = (char*)scratch_malloc(row_bytes);
+        hs.g_tmp = (char*)scratch_malloc(row_bytes);
+        hs.keep = (uint64_t*)scratch_malloc(DP_HS_BASE_ITEMS * words * sizeof(uint64_t));
+        hs.selected = selected;
+        if (hs.f && hs.f_tmp && hs.g && hs.g_tmp && hs.keep) {
+            best = dpi_hirschberg(&hs, 0, n, int_capacity);
+        }
+        scratch_free(hs.f);
+        scratch_free(hs.f_tmp);
+        scratch_free(hs.g);
+        scratch_free(hs.g_tmp);
+        scratch_free(hs.keep);
+    }
+    if (best < 0) knapsack_last_status = KS_STATUS_NO_MEMORY;
+    else *max_value = (double)best / scale;
+    scratch_free(int_weight);
+    scratch_free(int_value);
+}
+
+// ---------------- 稀疏动态规划（Nemhauser–Ullmann 支配表） ----------------
+// 每放入一个物品，只保留 Pareto 最优的 (重量, 价值) 状态：按重量递增排列时价值严格递增。
+// 新表由旧表与"旧表 + 当前物品"两条有序表归并得到，归并时丢掉被支配（更重却不更值钱）和超重的状态。
+// 直接使用 double 重量，没有 ×100 的取整误差；代价随可达状态数而不是容量精度增长。
+// 浮点累加的重量可能比真实值略大（0.10 + 0.20 > 0.30），容量判断放宽 SPARSE_EPS（相对容量），恰好装满的状态不会被丢掉。
+// 每个"选了当前物品"的状态在结点池中记一个结点（父结点 + 物品），用于回溯出选择方案
+#define SPARSE_MAX_NODES (1 << 26) // 结点池上限（约 512MB）
+#define SPARSE_EPS 1e-9              // 容量判断的相对容差
+
+typedef struct {
+    int parent;  // 父结点，-1 表示空集
+    int item;    // 该结点选中的物品
+} SparseNode;
+
+KS_THREAD_LOCAL long long sparse_last_states = 0; // 最近一次稀疏DP累计保留的状态数
+KS_THREAD_LOCAL int sparse_last_max_list = 0;     // 最近一次稀疏DP单层表的最大长度
+
+void sparse_dp(Item* items, int n, double capacity, int* selected, double* max_value) {
+    *max_value = 0;
+    sparse_last_states = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    sparse_last_max_list = 0;
+    for (int i = 0; i < n; i++) selected[i] = 0;
+    if (n <= 0 || capacity < 0) return;
+    double limit = capacity + SPARSE_EPS * (capacity > 1 ? capacity : 1);
+
+    // 两块交替使用的状态表（重量、价值、结点）
+    int list_cap = 1024;
+    double* w_a = (double*)scratch_malloc(list_cap * sizeof(double));
+    double* v_a = (double*)scratch_malloc(list_cap * sizeof(double));
+    int* node_a = (int*)scratch_malloc(list_cap * sizeof(int));
+    double* w_b = (double*)scratch_malloc(list_cap * sizeof(double));
+    double* v_b = (double*)scratch_malloc(list_cap * sizeof(double));
+    int* node_b = (int*)scratch_malloc(list_cap * sizeof(int));
+    int pool_cap = 1024, pool_size = 0;
+    SparseNode* pool = (SparseNode*)scratch_malloc(pool_cap * sizeof(SparseNode));
+    int size = 1, ok = 1;
+    w_a[0] = 0;
+    v_a[0] = 0;
+    node_a[0] = -1;
+    sparse_last_states = 1;
+
+    for (int i = 0; i < n && ok; i++) {
+        double wi = items[i].weight, vi = items[i].value;
+        // 新表最多 2*size 个状态，先保证容量
+        if (2 * size > list_cap) {
+            int new_cap = list_cap;
+            while (new_cap < 2 * size) new_cap *= 2;
+            double* nw_a = (double*)scratch_malloc(new_cap * sizeof(double));
+            double* nv_a = (double*)scratch_malloc(new_cap * sizeof(double));
+            int* nn_a = (int*)scratch_malloc(new_cap * sizeof(int));
+            scratch_free(w_b);
+            scratch_free(v_b);
+            scratch_free(node_b);
+            w_b = (double*)scratch_malloc(new_cap * sizeof(double));
+            v_b = (double*)scratch_malloc(new_cap * sizeof(double));
+            node_b = (int*)scratch_malloc(new_cap * sizeof(int));
+            if (!nw_a || !nv_a || !nn_a || !w_b || !v_b || !node_b) {
+                scratch_free(nw_a);
+                scratch_free(nv_a);
+                scratch_free(nn_a);
+                ok = 0;
+                break;
+            }
+            memcpy(nw_a, w_a, size * sizeof(double));
+            memcpy(nv_a, v_a, size * sizeof(double));
+            memcpy(nn_a, node_a, size * sizeof(int));
+            scratch_free(w_a);
+            scratch_free(v_a);
+            scratch_free(node_a);
+            w_a = nw_a;
+            v_a = nv_a;
+            node_a = nn_a;
+            list_cap = new_cap;
+        }
+
+        // 归并旧表 (w_a[p], v_a[p]) 与平移表 (w_a[q] + wi, v_a[q] + vi)
+        int p = 0, q = 0, m = 0;
+        while (p < size || q < size) {
+            double qw = q < size ? w_a[q] + wi : DBL_MAX;
+            if (qw > limit) {
+                qw = DBL_MAX;
+                if (p >= size) break;
+            }
+            double cw, cv;
+            int from_shift;
+            if (p < size && (w_a[p] < qw || (w_a[p] == qw && v_a[p] >= v_a[q] + vi))) {
+                cw = w_a[p];
+                cv = v_a[p];
+                from_shift = 0;
+                p++;
+            } else {
+                cw = qw;
+                cv = v_a[q] + vi;
+                from_shift = 1;
+                q++;
+            }
+            if (m > 0 && cv <= v_b[m - 1]) continue; // 被更轻（或同重）的状态支配
+            if (m > 0 && cw == w_b[m - 1]) m--;       // 同重量但价值更大，替换
+            w_b[m] = cw;
+            v_b[m] = cv;
+            if (from_shift) {
+                if (pool_size == pool_cap) {
+                    if (pool_cap >= SPARSE_MAX_NODES) {
+                        ok = 0;
+                        break;
+                    }
+                    SparseNode* np = (SparseNode*)scratch_malloc(pool_cap * 2 * sizeof(SparseNode));
+                    if (!np) {
+                        ok = 0;
+                        break;
+                    }
+                    memcpy(np, pool, pool_size * sizeof(SparseNode));
+                    scratch_free(pool);
+                    pool = np;
+                    pool_cap *= 2;
+                }
+                pool[pool_size].parent = node_a[q - 1];
+                pool[pool_size].item = i;
+                node_b[m] = pool_size++;
+            } else {
+                node_b[m] = node_a[p - 1];
+            }
+            m++;
+        }
+        if (!ok) break;
+
+        double* tw = w_a; w_a = w_b; w_b = tw;
+        double* tv = v_a; v_a = v_b; v_b = tv;
+        int* tn = node_a; node_a = node_b; node_b = tn;
+        size = m;
+        sparse_last_states += size;
+        if (size > sparse_last_max_list) sparse_last_max_list = size;
+    }
+
+    if (ok) {
+        // 价值随重量严格递增，最后一个状态最优
+        *max_value = v_a[size - 1];
+        for (int node = node_a[size - 1]; node >= 0; node = pool[node].parent) {
+            selected[pool[node].item] = 1;
+        }
+    } else {
+        knapsack_last_status = KS_STATUS_TOO_MANY_STATES;
+    }
+    scratch_free(w_a);
+    scratch_free(v_a);
+    scratch_free(node_a);
+    scratch_free(w_b);
+    scratch_free(v_b);
+    scratch_free(node_b);
+    scratch_free(pool);
+}
+
+// 比较函数：按价值/重量比降序排序
+int cmp(const void* a, const void* b) {
+    double ratio_a = ((Item*)a)->value / ((Item*)a)->weight;
+    double ratio_b = ((Item*)b)->value / ((Item*)b)->weight;
+    return ratio_a < ratio_b ? 1 : -1;
+}
+
+// 选择排序实现（按价值/重量比降序）
+void selection_sort(Item* items, int n) {
+    for (int i = 0; i < n - 1; i++) {
+        int max_idx = i;
+        double max_ratio = items[i].value / items[i].weight;
+        for (int j = i + 1; j < n; j++) {
+            double ratio = items[j].value / items[j].weight;
+            if (ratio > max_ratio) {
+                max_ratio = ratio;
+                max_idx = j;
+            }
+        }
+        if (max_idx != i) {
+            Item tmp = items[i];
+            items[i] = items[max_idx];
+            items[max_idx] = tmp;
+        }
+    }
+}
+
+// 贪心法
+void greedy(Item* items, int n, double capacity, int* selected, double* max_value) {
+    perf_mark(-1);
+    qsort(items, n, sizeof(Item), cmp);
+    perf_mark(KS_PHASE_GREEDY_SORT);
+    double total_weight = 0;
+    *max_value = 0;
+    for (int i = 0; i < n; i++) {
+        if (total_weight + items[i].weight <= capacity) {
+            selected[i] = 1;
+            total_weight += items[i].weight;
+            *max_value += items[i].value;
+        } else {
+            selected[i] = 0;
+        }
+    }
+    perf_mark(KS_PHASE_GREEDY_FILL);
+}
+
+// 贪心法（选择排序版）
+void greedy_selection(Item* items, int n, double capacity, int* selected, double* max_value) {
+    // 复制一份数据，避免影响原数组
+    Item* items_copy = (Item*)scratch_malloc(n * sizeof(Item));
+    memcpy(items_copy, items, n * sizeof(Item));
+    selection_sort(items_copy, n);
+    double total_weight = 0;
+    *max_value = 0;
+    for (int i = 0; i < n; i++) {
+        if (total_weight + items_copy[i].weight <= capacity) {
+            selected[i] = 1;
+            total_weight += items_copy[i].weight;
+            *max_value += items_copy[i].value;
+        } else {
+            selected[i] = 0;
+        }
+    }
+    scratch_free(items_copy);
+}
+
+// 贪心法（快速选择版）：比值只算一次，用带权快速选择（三路划分）在期望 O(n) 内找到断点物品，
+// 断点之前的物品整体选中、无需排序；断点之后只把放得下的物品建成按比值的大根堆依次尝试，
+// 结果与按比值全排序后逐个尝试的 greedy() 相同（比值相同的物品顺序可能不同）。
+// 与 greedy() 不同，不会改变 items 的顺序，selected 按原下标给出
+typedef struct {
+    double ratio;   // 价值/重量
+    double weight;
+    double value;
+    int idx;        // 原下标
+} RatioEntry;
+
+static void ratio_swap(RatioEntry* a, RatioEntry* b) {
+    RatioEntry t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// 按比值的大根堆下沉
+static void ratio_heap_down(RatioEntry* heap, int size, int i) {
+    while (1) {
+        int c = 2 * i + 1;
+        if (c >= size) break;
+        if (c + 1 < size && heap[c + 1].ratio > heap[c].ratio) c++;
+        if (heap[c].ratio <= heap[i].ratio) break;
+        ratio_swap(&heap[c], &heap[i]);
+        i = c;
+    }
+}
+
+// 只保留重量不超过 limit 的物品并重新建堆，返回新的堆大小
+static int ratio_heap_rebuild(RatioEntry* heap, int size, double limit) {
+    int m = 0;
+    for (int i = 0; i < size; i++) {
+        if (heap[i].weight <= limit) heap[m++] = heap[i];
+    }
+    for (int i = m / 2 - 1; i >= 0; i--) ratio_heap_down(heap, m, i);
+    return m;
+}
+
+// 三路划分 e[lo, hi)：[lo, *gt) 比值大于 pivot，[*gt, *lt) 等于，[*lt, hi) 小于；返回大于部分的总重量
+static double ratio_partition(RatioEntry* e, int lo, int hi, double pivot, int* gt, int* lt) {
+    int g = lo, i = lo, l = hi;
+    double sum_gt = 0;
+    while (i < l) {
+        if (e[i].ratio > pivot) {
+            sum_gt += e[i].weight;
+            ratio_swap(&e[i++], &e[g++]);
+        } else if (e[i].ratio < pivot) {
+            ratio_swap(&e[i], &e[--l]);
+        } else {
+            i++;
+        }
+    }
+    *gt = g;
+    *lt = l;
+    return sum_gt;
+}
+
+// 在 [lo, hi) 中随机取一个比值作为划分基准
+static double ratio_pivot(const RatioEntry* e, int lo, int hi, unsigned int* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return e[lo + (int)((*seed >> 8) % (unsigned int)(hi - lo))].ratio;
+}
+
+// 带权快速选择找断点（第一个装不下的物品）：重排 e[0, n)，使 [0, brk) 的比值都不小于 e[brk]、
+// (brk, n) 都不大于 e[brk]，且 [0, brk) 的总重量不超过 capacity。全部放得下时返回 n，*remain 为剩余容量
+static int ratio_find_break(RatioEntry* e, int n, double capacity, double* remain) {
+    // [0, lo) 为已确定整体选中的物品，断点在 [lo, hi) 中
+    int lo = 0, hi = n;
+    unsigned int seed = 12345u;
+    *remain = capacity;
+    while (lo < hi) {
+        int gt, lt;
+        double sum_gt = ratio_partition(e, lo, hi, ratio_pivot(e, lo, hi, &seed), &gt, &lt);
+        if (sum_gt > *remain) {
+            hi = gt; // 断点在比值更大的部分
+            continue;
+        }
+        *remain -= sum_gt;
+        for (lo = gt; lo < lt; lo++) { // 比值相等的部分按顺序装
+            if (e[lo].weight > *remain) return lo;
+            *remain -= e[lo].weight;
+        }
+    }
+    return lo;
+}
+
+// 快速选择：重排 e[lo, hi)，使 e[k] 为按比值降序排序后该位置的元素，[lo, k) 不小于它，(k, hi) 不大于它
+static void ratio_select(RatioEntry* e, int lo, int hi, int k) {
+    unsigned int seed = 54321u;
+    if (k < lo || k >= hi) return;
+    while (hi - lo > 1) {
+        int gt, lt;
+        ratio_partition(e, lo, hi, ratio_pivot(e, lo, hi, &seed), &gt, &lt);
+        if (k < gt) hi = gt;
+        else if (k >= lt) lo = lt;
+        else return;
+    }
+}
+
+static void greedy_fast_entries(RatioEntry* e, int n, double capacity, int* selected, double* max_value) {
+    double remain;
+    int brk = ratio_find_break(e, n, capacity, &remain);
+    for (int i = 0; i < brk; i++) {
+        selected[e[i].idx] = 1;
+        *max_value += e[i].value;
+    }
+
+    // 断点之后：只对放得下的物品按比值建堆，剩余容量减半时重新过滤
+    int size = ratio_heap_rebuild(e + brk, n - brk, remain);
+    RatioEntry* heap = e + brk;
+    double rebuild_at = remain / 2;
+    while (size > 0) {
+        RatioEntry top = heap[0];
+        heap[0] = heap[--size];
+        ratio_heap_down(heap, size, 0);
+        if (top.weight <= remain) {
+            selected[top.idx] = 1;
+            *max_value += top.value;
+            remain -= top.weight;
+            if (remain < rebuild_at) {
+                size = ratio_heap_rebuild(heap, size, remain);
+                rebuild_at = remain / 2;
+            }
+        }
+    }
+}
+
+void greedy_fast(Item* items, int n, double capacity, int* selected, double* max_value) {
+    *max_value = 0;
+    if (n <= 0) return;
+    RatioEntry* e = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+    for (int i = 0; i < n; i++) {
+        e[i].ratio = items[i].value / items[i].weight;
+        e[i].weight = items[i].weight;
+        e[i].value = items[i].value;
+        e[i].idx = i;
+        selected[i] = 0;
+    }
+    greedy_fast_entries(e, n, capacity, selected, max_value);
+    scratch_free(e);
+}
+
+// ---------------- 核心算法（Core，Pisinger 扩展核） ----------------
+// 用带权快速选择找到断点物品 b，只对 b 附近的"核"内物品做精确 DP：核之前的物品固定选中，核之后的固定不选。
+// 对核外每个物品 j 计算"翻转 j 的选择"后的线性松弛上界：
+//   j 在核之前（固定选中）：U - v_j + w_j * r_b；j 在核之后（固定不选）：U + v_j - w_j * r_b，
+// 其中 U 为整体线性松弛上界，r_b 为断点物品的比值。任何与当前固定方式不同的解至少翻转一个核外物品，
+// 所以这些上界都不超过核解的值时核解就是最优解，否则把核扩大一倍重算。
+// 整个数组不排序：每轮用快速选择把与断点比值最接近的物品移到断点两侧，只对核内物品排序。
+// 重量按 ×100 转成整数，与 dynamic_programming 的模型一致
+#define CORE_INIT_HALF 16 // 初始核为断点左右各 16 个物品
+#define CORE_EPS 1e-9     // 上界与核解之差不超过 CORE_EPS * |核解| 时认为已证明最优
+
+KS_THREAD_LOCAL int core_last_size = 0; // 最近一次核算法最终使用的核大小
+
+static int ratio_entry_cmp(const void* a, const void* b) {
+    double x = ((const RatioEntry*)a)->ratio;
+    double y = ((const RatioEntry*)b)->ratio;
+    return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+// 断点为 b 时，核 [lo, hi) 之外翻转一个物品后的最大上界，没有核外物品时返回 -1
+static double core_outside_bound(const RatioEntry* e, int n, int lo, int hi,
+                                 double lp_bound, double r_b, int int_capacity) {
+    double ub = -1;
+    for (int j = 0; j < lo; j++) {
+        double u = lp_bound - e[j].value + e[j].weight * r_b;
+        if (u > ub) ub = u;
+    }
+    for (int j = hi; j < n; j++) {
+        if (e[j].weight > int_capacity) continue; // 单独都放不下，不可能被选中
+        double u = lp_bound + e[j].value - e[j].weight * r_b;
+        if (u > ub) ub = u;
+    }
+    return ub;
+}
+
+// e 中的重量已按 ×100 取整；求解过程会重排 e
+static void core_solve_entries(RatioEntry* e, int n, int int_capacity, int* selected, double* max_value) {
+    double remain;
+    int b = ratio_find_break(e, n, int_capacity, &remain);
+    if (b == n) {
+        for (int i = 0; i < n; i++) {
+            selected[e[i].idx] = 1;
+            *max_value += e[i].value;
+        }
+        return;
+    }
+    double r_b = e[b].ratio;
+    double lp_bound = remain * r_b;
+    for (int j = 0; j < b; j++) lp_bound += e[j].value;
+
+    int* core_w = (int*)scratch_malloc(n * sizeof(int));
+    double* core_v = (double*)scratch_malloc(n * sizeof(double));
+    int* core_sel = (int*)scratch_malloc(n * sizeof(int));
+    int half = CORE_INIT_HALF;
+    int lo, hi;
+    double z = -1;
+    while (1) {
+        lo = b - half > 0 ? b - half : 0;
+        hi = b + half + 1 < n ? b + half + 1 : n;
+        // 断点左侧比值最小的 b-lo 个移到 [lo, b)，右侧比值最大的 hi-b-1 个移到 (b, hi)，核内排序
+        ratio_select(e, 0, b, lo);
+        ratio_select(e, b + 1, n, hi - 1);
+        qsort(e + lo, hi - lo, sizeof(RatioEntry), ratio_entry_cmp);
+        long long fixed_w = 0;
+        double fixed_v = 0;
+        for (int j = 0; j < lo; j++) {
+            fixed_w += (long long)e[j].weight;
+            fixed_v += e[j].value;
+        }
+        for (int j = lo; j < hi; j++) {
+            core_w[j - lo] = (int)e[j].weight;
+            core_v[j - lo] = e[j].value;
+        }
+        double core_value = dp_solve_arrays(core_w, core_v, hi - lo, (int)(int_capacity - fixed_w), core_sel, 1);
+        if (core_value < 0) {
+            knapsack_last_status = KS_STATUS_NO_MEMORY;
+            z = -1;
+            break;
+        }
+        z = fixed_v + core_value;
+        if (lo == 0 && hi == n) break;
+        double ub = core_outside_bound(e, n, lo, hi, lp_bound, r_b, int_capacity);
+        if (ub - z <= CORE_EPS * (z > 1 ? z : 1)) break;
+        half *= 2;
+    }
+    if (z >= 0) {
+        for (int j = 0; j < lo; j++) selected[e[j].idx] = 1;
+        for (int j = lo; j < hi; j++) selected[e[j].idx] = core_sel[j - lo];
+        *max_value = z;
+        core_last_size = hi - lo;
+    }
+    scratch_free(core_w);
+    scratch_free(core_v);
+    scratch_free(core_sel);
+}
+
+void core_solver(Item* items, int n, double capacity, int* selected, double* max_value) {
+    int scale = 100;
+    int int_capacity = (int)(capacity * scale + 0.5);
+    *max_value = 0;
+    core_last_size = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    RatioEntry* e = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+    for (int i = 0; i < n; i++) {
+        int w = (int)(items[i].weight * scale + 0.5);
+        e[i].weight = w;
+        e[i].value = items[i].value;
+        e[i].ratio = w > 0 ? items[i].value / w : DBL_MAX;
+        e[i].idx = i;
+        selected[i] = 0;
+    }
+    core_solve_entries(e, n, int_capacity, selected, max_value);
+    scratch_free(e);
+}
+
+// ---------------- 限时求解（anytime） ----------------
+// 在截止时间内尽量改进解，并给出已证明的最优性差距：
+//   1. 断点解加上断点之后放得下的物品（与 greedy_fast 相同），O(n)；
+//   2. 在断点附近的窗口内做交换局部搜索（换出一个已选物品、换入一个未选物品）；
+//   3. 与核心算法相同地做核DP并逐轮把核扩大一倍，预计下一轮会超过截止时间就停止。
+// 上界一开始是线性松弛上界 U；每完成一轮核DP，任何更好的解都至少翻转一个核外物品，
+// 上界收紧为 max(核解, 核外翻转上界)。重量按 ×100 取整，与核心算法、DP 的模型一致
+#define ANYTIME_SWAP_HALF 32   // 局部搜索窗口：断点左右各 32 个物品
+#define ANYTIME_SWAP_ROUNDS 16 // 局部搜索最多交换的次数
+#define ANYTIME_CALIBRATE_CELLS (1 << 16) // 第一轮核DP前先在这么多个单元上试算，估计每个单元的耗时
+#define ANYTIME_CALIBRATE_MARGIN 2.0      // 试算的表小、都在缓存里，正式一轮按试算结果的 2 倍估计
+
+// 窗口 [lo, hi) 内的交换局部搜索：每次做增益最大的一次加入或交换，used 为当前已用容量
+static void anytime_local_search(const RatioEntry* e, int lo, int hi, int int_capacity, int* selected,
+                                 double* value, long long* used) {
+    for (int round = 0; round < ANYTIME_SWAP_ROUNDS; round++) {
+        double best_gain = 0;
+        int best_out = -1, best_in = -1;
+        long long room = int_capacity - *used;
+        for (int j = lo; j < hi; j++) {
+            if (selected[e[j].idx]) continue;
+            if (e[j].weight <= room && e[j].value > best_gain) { // 直接加入
+                best_gain = e[j].value;
+                best_out = -1;
+                best_in = j;
+            }
+            for (int i = lo; i < hi; i++) {
+                if (!selected[e[i].idx]) continue;
+                if (e[j].weight - e[i].weight <= room && e[j].value - e[i].value > best_gain) {
+                    best_gain = e[j].value - e[i].value;
+                    best_out = i;
+                    best_in = j;
+                }
+            }
+        }
+        if (best_in < 0) break;
+        if (best_out >= 0) {
+            selected[e[best_out].idx] = 0;
+            *used -= (long long)e[best_out].weight;
+        }
+        selected[e[best_in].idx] = 1;
+        *used += (long long)e[best_in].weight;
+        *value += best_gain;
+    }
+}
+
+typedef struct {
+    RatioEntry* e;
+    RatioEntry* rest;  // 断点之后物品的副本，贪心填充时会被重排
+    int* core_w;
+    double* core_v;
+    int* core_sel;
+} AnytimeBuffers;
+
+// 依次执行三个阶段，随时可停；返回找到的解的价值，st->upper 为已证明的上界
+static double anytime_search(const AnytimeBuffers* buf, int n, int int_capacity, uint64_t deadline, int* selected,
+                             KnapsackAnytimeStats* st) {
+    RatioEntry* e = buf->e;
+
+    // 1. 断点解 + 断点之后的贪心填充
+    double remain;
+    int b = ratio_find_break(e, n, int_capacity, &remain);
+    double z = 0;
+    long long used = 0;
+    for (int j = 0; j < b; j++) {
+        selected[e[j].idx] = 1;
+        z += e[j].value;
+        used += (long long)e[j].weight;
+    }
+    if (b == n) { // 全部放得下
+        st->upper = z;
+        return z;
+    }
+    double r_b = e[b].ratio;
+    double lp_bound = z + remain * r_b;
+    st->upper = lp_bound;
+    memcpy(buf->rest, e + b, (n - b) * sizeof(RatioEntry));
+    double rest_value = 0;
+    greedy_fast_entries(buf->rest, n - b, remain, selected, &rest_value);
+    z += rest_value;
+    for (int j = b; j < n; j++) { // 堆操作会覆盖 rest 中的元素，已用容量按 e 统计
+        if (selected[e[j].idx]) used += (long long)e[j].weight;
+    }
+
+    // 2. 断点附近的交换局部搜索
+    int lo = b - ANYTIME_SWAP_HALF > 0 ? b - ANYTIME_SWAP_HALF : 0;
+    int hi = b + ANYTIME_SWAP_HALF + 1 < n ? b + ANYTIME_SWAP_HALF + 1 : n;
+    ratio_select(e, 0, b, lo);
+    ratio_select(e, b + 1, n, hi - 1);
+    anytime_local_search(e, lo, hi, int_capacity, selected, &z, &used);
+
+    // 3. 核DP，逐轮扩大核，直到证明最优、核覆盖全部物品或时间不够
+    double ns_per_cell = -1; // 上一轮核DP每个表格单元的耗时，用于预估下一轮；第一轮前用试算结果
+    for (int half = CORE_INIT_HALF; ; half *= 2) {
+        if (knapsack_now_ns() >= deadline) break;
+        lo = b - half > 0 ? b - half : 0;
+        hi = b + half + 1 < n ? b + half + 1 : n;
+        ratio_select(e, 0, b, lo);
+        ratio_select(e, b + 1, n, hi - 1);
+        qsort(e + lo, hi - lo, sizeof(RatioEntry), ratio_entry_cmp);
+        long long fixed_w = 0;
+        double fixed_v = 0;
+        for (int j = 0; j < lo; j++) {
+            fixed_w += (long long)e[j].weight;
+            fixed_v += e[j].value;
+        }
+        double cells = (double)(hi - lo) * (double)(int_capacity - fixed_w + 1);
+        for (int j = lo; j < hi; j++) {
+            buf->core_w[j - lo] = (int)e[j].weight;
+            buf->core_v[j - lo] = e[j].value;
+        }
+        if (ns_per_cell < 0) { // 第一轮：在同一个核、较小的容量上试算
+            int cal_cap = ANYTIME_CALIBRATE_CELLS / (hi - lo);
+            if (cal_cap > int_capacity - fixed_w) cal_cap = (int)(int_capacity - fixed_w);
+            uint64_t t0 = knapsack_now_ns();
+            dp_solve_arrays(buf->core_w, buf->core_v, hi - lo, cal_cap, buf->core_sel, 1);
+            ns_per_cell = ANYTIME_CALIBRATE_MARGIN * (knapsack_now_ns() - t0) / ((double)(hi - lo) * (cal_cap + 1));
+        }
+        uint64_t now = knapsack_now_ns();
+        if (now + (uint64_t)(cells * ns_per_cell) > deadline) break; // 预计做不完
+        double core_value = dp_solve_arrays(buf->core_w, buf->core_v, hi - lo, (int)(int_capacity - fixed_w),
+                                            buf->core_sel, 1);
+        if (core_value < 0) break; // 内存不足，保留已有的解
+        double core_z = fixed_v + core_value;
+        st->core_size = hi - lo;
+        st->iterations++;
+        if (core_z > z) {
+            z = core_z;
+            for (int j = 0; j < n; j++) selected[e[j].idx] = j < lo ? 1 : (j < hi ? buf->core_sel[j - lo] : 0);
+        }
+        double ub = lo == 0 && hi == n ? core_z : core_outside_bound(e, n, lo, hi, lp_bound, r_b, int_capacity);
+        if (ub < core_z) ub = core_z;
+        if (ub < st->upper) st->upper = ub;
+        ns_per_cell = (knapsack_now_ns() - now) / cells;
+        if (st->upper - z <= CORE_EPS * (z > 1 ? z : 1) || (lo == 0 && hi == n)) break;
+    }
+    return z;
+}
+
+void knapsack_anytime(Item* items, int n, double capacity, double deadline_ms, int* selected, double* max_value,
+                      KnapsackAnytimeStats* stats) {
+    uint64_t start = knapsack_now_ns();
+    uint64_t deadline = start + (uint64_t)(deadline_ms > 0 ? deadline_ms * 1e6 : 0);
+    int scale = 100;
+    int int_capacity = (int)(capacity * scale + 0.5);
+    KnapsackAnytimeStats st;
+    memset(&st, 0, sizeof(st));
+    *max_value = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    for (int i = 0; i < n; i++) selected[i] = 0;
+    if (n > 0 && int_capacity >= 0) {
+        AnytimeBuffers buf;
+        buf.e = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+        buf.rest = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+        buf.core_w = (int*)scratch_malloc(n * sizeof(int));
+        buf.core_v = (double*)scratch_malloc(n * sizeof(double));
+        buf.core_sel = (int*)scratch_malloc(n * sizeof(int));
+        if (buf.e && buf.rest && buf.core_w && buf.core_v && buf.core_sel) {
+            for (int i = 0; i < n; i++) {
+                int w = (int)(items[i].weight * scale + 0.5);
+                buf.e[i].weight = w;
+                buf.e[i].value = items[i].value;
+                buf.e[i].ratio = w > 0 ? items[i].value / w : DBL_MAX;
+                buf.e[i].idx = i;
+            }
+            double z = anytime_search(&buf, n, int_capacity, deadline, selected, &st);
+            if (st.upper < z) st.upper = z;
+            *max_value = z;
+            st.lower = z;
+            st.gap = st.upper > 0 ? (st.upper - z) / st.upper : 0;
+            if (st.gap <= CORE_EPS) st.gap = 0;
+        } else {
+            knapsack_last_status = KS_STATUS_NO_MEMORY;
+        }
+        scratch_free(buf.e);
+        scratch_free(buf.rest);
+        scratch_free(buf.core_w);
+        scratch_free(buf.core_v);
+        scratch_free(buf.core_sel);
+    }
+    st.elapsed_ms = (knapsack_now_ns() - start) / 1e6;
+    if (stats) *stats = st;
+}
+
+// ---------------- 分支限界法 ----------------
+// 物品按价值/重量比降序排列，上界取线性松弛（Dantzig）界：剩余容量按比值贪心装入，最后一个物品可取分数；
+// 初始下界来自贪心法，支持深度优先与最佳优先（按上界的优先队列）两种搜索方式。
+// 重量与 DP 相同按 ×100 取整，容量判断用整数比较，恰好装满的组合不会因浮点累加误差被拒绝
+#define BB_EPS 1e-9                 // 上界不超过当前最优 + BB_EPS 时剪枝
+#define BB_MAX_NODES (1 << 22)      // 最佳优先搜索保存的结点上限，超过后改用深度优先继续
+
+typedef struct {
+    int n;
+    long long capacity;     // 容量 ×100
+    const long long* weight; // 排序后的重量 ×100
+    const double* value;    // 排序后的价值
+    long long* prefix_w;    // prefix_w[i] 为前 i 个物品的重量和
+    double* prefix_v;
+    unsigned char* curr;    // 深度优先时的当前选择
+    unsigned char* best;    // 当前最优选择（排序后下标）
+    double best_value;
+    long long nodes;        // 扩展的结点数
+} BBContext;
+
+KS_THREAD_LOCAL long long bb_last_nodes = 0; // 最近一次分支限界扩展的结点数
+
+// 从第 idx 个物品开始、已用重量 cw、已得价值 cv 时的线性松弛上界
+static double bb_bound(const BBContext* bb, int idx, long long cw, double cv) {
+    long long remain = bb->capacity - cw;
+    // 二分查找能整个装入的最后位置 k：prefix_w[k] - prefix_w[idx] <= remain
+    int lo = idx, hi = bb->n;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (bb->prefix_w[mid] - bb->prefix_w[idx] <= remain) lo = mid;
+        else hi = mid - 1;
+    }
+    double bound = cv + bb->prefix_v[lo] - bb->prefix_v[idx];
+    if (lo < bb->n) {
+        bound += (double)(remain - (bb->prefix_w[lo] - bb->prefix_w[idx])) * bb->value[lo] / bb->weight[lo];
+    }
+    return bound;
+}
+
+// 深度优先分支限界：先走"选"分支，尽快得到好的下界
+static void bb_dfs(BBContext* bb, int idx, long long cw, double cv) {
+    bb->nodes++;
+    if (cv > bb->best_value) {
+        bb->best_value = cv;
+        memcpy(bb->best, bb->curr, bb->n);
+        for (int i = idx; i < bb->n; i++) bb->best[i] = 0;
+    }
+    if (idx == bb->n) return;
+    if (bb_bound(bb, idx, cw, cv) - bb->best_value <= BB_EPS) return;
+
+    if (cw + bb->weight[idx] <= bb->capacity) {
+        bb->curr[idx] = 1;
+        bb_dfs(bb, idx + 1, cw + bb->weight[idx], cv + bb->value[idx]);
+        bb->curr[idx] = 0;
+    }
+    bb_dfs(bb, idx + 1, cw, cv);
+}
+
+// 最佳优先搜索的结点：通过 parent 回溯得到选择方案
+typedef struct {
+    int level;      // 已决定前 level 个物品
+    int parent;     // 父结点下标，根为 -1
+    int take;       // 是否选了第 level-1 个物品
+    long long weight;
+    double value;
+    double bound;
+} BBNode;
+
+// 大根堆（按上界），保存结点下标
+static void bb_heap_push(int* heap, int* size, const BBNode* pool, int node) {
+    int i = (*size)++;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (pool[heap[p]].bound >= pool[node].bound) break;
+        heap[i] = heap[p];
+        i = p;
+    }
+    heap[i] = node;
+}
+
+static int bb_heap_pop(int* heap, int* size, const BBNode* pool) {
+    int top = heap[0];
+    int last = heap[--(*size)];
+    int i = 0;
+    while (1) {
+        int c = 2 * i + 1;
+        if (c >= *size) break;
+        if (c + 1 < *size && pool[heap[c + 1]].bound > pool[heap[c]].bound) c++;
+        if (pool[heap[c]].bound <= pool[last].bound) break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    if (*size > 0) heap[i] = last;
+    return top;
+}
+
+// 最佳优先分支限界：每次扩展上界最大的结点；结点数超过 BB_MAX_NODES 时返回 0，由调用者改用深度优先
+static int bb_best_first(BBContext* bb) {
+    int pool_cap = 1024;
+    BBNode* pool = (BBNode*)scratch_malloc(pool_cap * sizeof(BBNode));
+    int* heap = (int*)scratch_malloc(pool_cap * sizeof(int));
+    int pool_size = 0, heap_size = 0, best_node = -1, finished = 1;
+    if (!pool || !heap) {
+        scratch_free(pool);
+        scratch_free(heap);
+        return 0;
+    }
+
+    BBNode root = {0, -1, 0, 0, 0, bb_bound(bb, 0, 0, 0)};
+    pool[pool_size++] = root;
+    bb_heap_push(heap, &heap_size, pool, 0);
+    while (heap_size > 0) {
+        int id = bb_heap_pop(heap, &heap_size, pool);
+        BBNode node = pool[id];
+        if (node.bound - bb->best_value <= BB_EPS) break; // 堆顶上界都不优，搜索结束
+        if (node.level == bb->n) continue;
+        if (pool_size + 2 > pool_cap) {
+            if (pool_cap * 2 > BB_MAX_NODES) {
+                finished = 0;
+                break;
+            }
+            BBNode* new_pool = (BBNode*)scratch_malloc(pool_cap * 2 * sizeof(BBNode));
+            int* new_heap = (int*)scratch_malloc(pool_cap * 2 * sizeof(int));
+            if (!new_pool || !new_heap) {
+                scratch_free(new_pool);
+                scratch_free(new_heap);
+                finished = 0;
+                break;
+            }
+            memcpy(new_pool, pool, pool_size * sizeof(BBNode));
+            memcpy(new_heap, heap, heap_size * sizeof(int));
+            scratch_free(pool);
+            scratch_free(heap);
+            pool = new_pool;
+            heap = new_heap;
+            pool_cap *= 2;
+        }
+        bb->nodes++;
+        int idx = node.level;
+        // 两个子结点：选 / 不选第 idx 个物品；每个结点本身（其余物品都不选）就是一个可行解
+        for (int take = 1; take >= 0; take--) {
+            BBNode child = {idx + 1, id, take, node.weight, node.value, 0};
+            if (take) {
+                if (node.weight + bb->weight[idx] > bb->capacity) continue;
+                child.weight += bb->weight[idx];
+                child.value += bb->value[idx];
+            }
+            child.bound = bb_bound(bb, idx + 1, child.weight, child.value);
+            int cid = pool_size++;
+            pool[cid] = child;
+            if (child.value > bb->best_value) {
+                bb->best_value = child.value;
+                best_node = cid;
+            }
+            if (child.bound - bb->best_value > BB_EPS) bb_heap_push(heap, &heap_size, pool, cid);
+        }
+    }
+
+    if (best_node >= 0) {
+        memset(bb->best, 0, bb->n);
+        for (int id = best_node; pool[id].parent >= 0; id = pool[id].parent) {
+            bb->best[pool[id].level - 1] = (unsigned char)pool[id].take;
+        }
+    }
+    scratch_free(pool);
+    scratch_free(heap);
+    return finished;
+}
+
+// 分支限界法：best_first 为 1 时最佳优先，否则深度优先
+void branch_and_bound(Item* items, int n, double capacity, int* selected, double* max_value, int best_first) {
+    *max_value = 0;
+    bb_last_nodes = 0;
+    if (n <= 0) return;
+    // 复制一份并借用 id 字段记录原下标，按比值排序
+    Item* sorted = (Item*)scratch_malloc(n * sizeof(Item));
+    long long* weight = (long long*)scratch_malloc(n * sizeof(long long));
+    double* value = (double*)scratch_malloc(n * sizeof(double));
+    BBContext bb;
+    bb.prefix_w = (long long*)scratch_malloc((n + 1) * sizeof(long long));
+    bb.prefix_v = (double*)scratch_malloc((n + 1) * sizeof(double));
+    bb.curr = (unsigned char*)scratch_calloc(n, 1);
+    bb.best = (unsigned char*)scratch_calloc(n, 1);
+    for (int i = 0; i < n; i++) {
+        sorted[i] = items[i];
+        sorted[i].id = i;
+    }
+    qsort(sorted, n, sizeof(Item), cmp);
+
+    bb.n = n;
+    bb.capacity = (long long)(capacity * 100 + 0.5);
+    bb.weight = weight;
+    bb.value = value;
+    bb.nodes = 0;
+    bb.prefix_w[0] = bb.prefix_v[0] = 0;
+    for (int i = 0; i < n; i++) {
+        weight[i] = (long long)(sorted[i].weight * 100 + 0.5);
+        value[i] = sorted[i].value;
+        bb.prefix_w[i + 1] = bb.prefix_w[i] + weight[i];
+        bb.prefix_v[i + 1] = bb.prefix_v[i] + value[i];
+    }
+    // 初始下界：按比值顺序的贪心解，与搜索一样用整数重量判断容量，保证返回的解一定可行
+    long long greedy_w = 0;
+    bb.best_value = 0;
+    for (int i = 0; i < n; i++) {
+        bb.best[i] = greedy_w + weight[i] <= bb.capacity;
+        if (bb.best[i]) {
+            greedy_w += weight[i];
+            bb.best_value += value[i];
+        }
+    }
+
+    if (!best_first || !bb_best_first(&bb)) {
+        bb_dfs(&bb, 0, 0, 0);
+    }
+
+    *max_value = bb.best_value;
+    for (int i = 0; i < n; i++) {
+        selected[sorted[i].id] = bb.best[i];
+    }
+    bb_last_nodes = bb.nodes;
+
+    scratch_free(sorted);
+    scratch_free(weight);
+    scratch_free(value);
+    scratch_free(bb.prefix_w);
+    scratch_free(bb.prefix_v);
+    scratch_free(bb.curr);
+    scratch_free(bb.best);
+}
+
+// ---------------- 求解器上下文 ----------------
+// 上下文持有内存池与物品副本，求解时把内存池设为当前线程的活动内存池，
+// 各算法原有的 scratch_* 调用因此不再走 malloc/free
+struct KnapsackContext {
+    ScratchArena arena;
+    Item* items;   // 物品副本（贪心法等会对物品排序，不能改动调用者的数组）
+    int items_cap; // 物品副本的容量
+    int threads;   // 多线程算法使用的线程数
+};
+
+KnapsackContext* knapsack_context_create(size_t arena_bytes) {
+    KnapsackContext* ctx = (KnapsackContext*)calloc(1, sizeof(KnapsackContext));
+    if (!ctx) return NULL;
+    if (arena_bytes > 0) {
+        ctx->arena.base = (char*)malloc(arena_bytes);
+        if (!ctx->arena.base) {
+            free(ctx);
+            return NULL;
+        }
+        ctx->arena.size = arena_bytes;
+    }
+    ctx->threads = cpu_count();
+    return ctx;
+}
+
+void knapsack_context_destroy(KnapsackContext* ctx) {
+    if (!ctx) return;
+    free(ctx->arena.base);
+    free(ctx->items);
+    free(ctx);
+}
+
+void knapsack_context_set_threads(KnapsackContext* ctx, int threads) {
+    ctx->threads = threads > 0 ? threads : cpu_count();
+}
+
+size_t knapsack_context_arena_size(const KnapsackContext* ctx) {
+    return ctx->arena.size;
+}
+
+size_t knapsack_context_high_water(const KnapsackContext* ctx) {
+    return ctx->arena.high_water;
+}
+
+// 求解前把内存池扩到历史最高用量、物品副本扩到 n，只有规模变大时才会真正分配
+static int knapsack_context_reserve(KnapsackContext* ctx, int n) {
+    if (ctx->arena.high_water > ctx->arena.size) {
+        char* base = (char*)malloc(ctx->arena.high_water);
+        if (base) { // 扩容失败时沿用旧池，超出部分照常退回 malloc
+            free(ctx->arena.base);
+            ctx->arena.base = base;
+            ctx->arena.size = ctx->arena.high_water;
+        }
+    }
+    if (n > ctx->items_cap) {
+        Item* items = (Item*)malloc(n * sizeof(Item));
+        if (!items) return -1;
+        free(ctx->items);
+        ctx->items = items;
+        ctx->items_cap = n;
+    }
+    return 0;
+}
+
+int knapsack_solve(KnapsackContext* ctx, KnapsackAlgo algo, const Item* items, int n,
+                   double capacity, int* selected, double* max_value) {
+    *max_value = 0;
+    if (!ctx || n < 0 || (n > 0 && (!items || !selected))) return -1;
+    if ((algo == KS_BRUTE_FORCE && n > 30) || (algo == KS_MEET_IN_MIDDLE && n > MITM_MAX_ITEMS) ||
+        (algo == KS_BRUTE_FORCE_GRAY && n > BF_GRAY_MAX_ITEMS)) {
+        return -1;
+    }
+    if (knapsack_context_reserve(ctx, n) != 0) return -1;
+    memcpy(ctx->items, items, n * sizeof(Item));
+    memset(selected, 0, n * sizeof(int));
+
+    ctx->arena.used = 0;
+    ctx->arena.overflow = 0;
+    g_arena = &ctx->arena;
+    g_scratch_failed = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    int status = 0;
+    Item* work = ctx->items;
+    switch (algo) {
+    case KS_BRUTE_FORCE:
+        brute_force(work, n, capacity, selected, max_value);
+        break;
+    case KS_BACKTRACK:
+        backtrack_iterative(work, n, capacity, selected, max_value, 1);
+        break;
+    case KS_DP:
+        dynamic_programming(work, n, capacity, selected, max_value);
+        break;
+    case KS_GREEDY: {
+        // 贪心法按排序后的位置标记 selected，这里借 id 记下原下标再映射回去
+        for (int i = 0; i < n; i++) work[i].id = i;
+        greedy(work, n, capacity, selected, max_value);
+        int* sorted_sel = (int*)scratch_malloc(n * sizeof(int));
+        if (!sorted_sel) break;
+        memcpy(sorted_sel, selected, n * sizeof(int));
+        for (int i = 0; i < n; i++) selected[work[i].id] = sorted_sel[i];
+        scratch_free(sorted_sel);
+        break;
+    }
+    case KS_DP_ROLLING:
+        dynamic_programming_rolling(work, n, capacity, selected, max_value);
+        break;
+    case KS_DP_PARALLEL:
+        dynamic_programming_parallel(work, n, capacity, selected, max_value, ctx->threads);
+        break;
+    case KS_BB_DFS:
+    case KS_BB_BEST_FIRST:
+        branch_and_bound(work, n, capacity, selected, max_value, algo == KS_BB_BEST_FIRST);
+        break;
+    case KS_MEET_IN_MIDDLE:
+        meet_in_middle(work, n, capacity, selected, max_value);
+        break;
+    case KS_BRUTE_FORCE_GRAY:
+        brute_force_gray(work, n, capacity, selected, max_value, ctx->threads);
+        break;
+    case KS_GREEDY_FAST:
+        greedy_fast(work, n, capacity, selected, max_value);
+        break;
+    case KS_CORE:
+        core_solver(work, n, capacity, selected, max_value);
+        break;
+    case KS_SPARSE_DP:
+        sparse_dp(work, n, capacity, selected, max_value);
+        break;
+    case KS_DP_INT:
+        dynamic_programming_int(work, n, capacity, selected, max_value);
+        break;
+    default:
+        status = -1;
+        break;
+    }
+    g_arena = NULL;
+    if (g_scratch_failed || knapsack_last_status == KS_STATUS_NO_MEMORY ||
+        knapsack_last_status == KS_STATUS_TOO_MANY_STATES) {
+        status = -1;
+    }
+    return status;
+}
+
+// ---------------- 批量求解 ----------------
+// 主线程按顺序读入实例，放进固定大小的环形槽位，再轮流推入各工作线程的双端队列；
+// 工作线程先从自己的队列取任务，取不到再从其他线程的队列窃取；两种情况都从头部取最老的任务，
+// 因为输出按输入顺序进行，最老的实例没完成时后面的结果都要等它。
+// 主线程在环满时等待最老的实例完成并输出，因此输出顺序与输入一致，在途实例数（即内存）有上限。
+// 每个工作线程有自己的 KnapsackContext，内存池在实例之间复用
+#define BATCH_RING_PER_THREAD 64 // 每个工作线程对应的在途实例数
+#define BATCH_LAT_BUCKETS 320    // 延迟直方图：从 1ns 起每 2 倍分 8 档，共 40 个 2 倍
+#define BATCH_SPARSE_MAX_N 64        // 物品数不超过该值时用稀疏DP（状态数不超过 2^n，也不超过不同重量的个数）
+#define BATCH_DP_MAX_CELLS (1 << 22) // 物品数 × 整数化容量不超过该值时用滚动DP
+
+typedef struct {
+    Item* items;
+    int* selected;
+    int cap;          // items/selected 的容量，只增不减
+    int n;
+    double capacity;
+    double max_value;
+    int status;       // knapsack_solve 的返回值
+    int done;         // 受 pool->lock 保护
+} BatchSlot;
+
+typedef struct {
+    int* buf;         // 槽位下标的环形数组
+    int size;
+    long long head;   // 出队端（最老的任务）
+    long long tail;   // 入队端
+    pthread_mutex_t lock;
+} BatchDeque;
+
+typedef struct BatchPool BatchPool;
+
+typedef struct {
+    BatchPool* pool;
+    int id;
+    unsigned long long hist[BATCH_LAT_BUCKETS];
+} BatchWorker;
+
+struct BatchPool {
+    BatchSlot* slots;
+    int ring;
+    BatchDeque* deques;
+    BatchWorker* workers;
+    int threads;
+    int pending;      // 已入队未取走的任务数（原子操作）
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond; // 有新任务或要求退出
+    pthread_cond_t done_cond; // 有实例完成
+};
+
+KnapsackAlgo knapsack_pick_algo(int n, double capacity) {
+    double cells = (double)n * (capacity * 100 + 1);
+    if (n <= BATCH_SPARSE_MAX_N) return KS_SPARSE_DP;
+    if (cells <= BATCH_DP_MAX_CELLS) return KS_DP_ROLLING;
+    return KS_CORE;
+}
+
+static void batch_deque_push(BatchDeque* dq, int slot) {
+    pthread_mutex_lock(&dq->lock);
+    dq->buf[dq->tail % dq->size] = slot;
+    dq->tail++;
+    pthread_mutex_unlock(&dq->lock);
+}
+
+// 从头部取最老的任务（所有者与窃取者相同，队列有锁保护，不需要分两端）
+static int batch_deque_take(BatchDeque* dq) {
+    int slot = -1;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->head < dq->tail) slot = dq->buf[dq->head++ % dq->size];
+    pthread_mutex_unlock(&dq->lock);
+    return slot;
+}
+
+static int batch_take(BatchPool* pool, int id) {
+    int slot = batch_deque_take(&pool->deques[id]);
+    for (int k = 1; slot < 0 && k < pool->threads; k++) {
+        slot = batch_deque_take(&pool->deques[(id + k) % pool->threads]);
+    }
+    if (slot >= 0) __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_ACQ_REL);
+    return slot;
+}
+
+static int batch_lat_bucket(unsigned long long ns) {
+    if (ns == 0) return 0;
+    int octave = 63 - __builtin_clzll(ns);
+    int sub = octave >= 3 ? (int)(ns >> (octave - 3)) & 7 : (int)(ns << (3 - octave)) & 7;
+    int b = octave * 8 + sub;
+    return b < BATCH_LAT_BUCKETS ? b : BATCH_LAT_BUCKETS - 1;
+}
+
+// 直方图档位的代表值（档位上下界的中点），单位纳秒
+static double batch_lat_value(int b) {
+    return (double)(1ULL << (b / 8)) * (1.0 + (b % 8 + 0.5) / 8.0);
+}
+
+static double batch_percentile(const unsigned long long* hist, unsigned long long total, double q) {
+    if (total == 0) return 0;
+    unsigned long long rank = (unsigned long long)(q * (total - 1)) + 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < BATCH_LAT_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= rank) return batch_lat_value(b);
+    }
+    return batch_lat_value(BATCH_LAT_BUCKETS - 1);
+}
+
+static void* batch_worker(void* arg) {
+    BatchWorker* self = (BatchWorker*)arg;
+    BatchPool* pool = self->pool;
+    KnapsackContext* ctx = knapsack_context_create(0);
+    if (ctx) knapsack_context_set_threads(ctx, 1);
+    while (1) {
+        int s = batch_take(pool, self->id);
+        if (s < 0) {
+            pthread_mutex_lock(&pool->lock);
+            while (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) == 0 && !pool->stop) {
+                pthread_cond_wait(&pool->work_cond, &pool->lock);
+            }
+            int quit = pool->stop && __atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) == 0;
+            pthread_mutex_unlock(&pool->lock);
+            if (quit) break;
+            continue;
+        }
+        BatchSlot* slot = &pool->slots[s];
+        uint64_t t_start = knapsack_now_ns();
+        slot->status = ctx ? knapsack_solve(ctx, knapsack_pick_algo(slot->n, slot->capacity), slot->items, slot->n,
+                                            slot->capacity, slot->selected, &slot->max_value) : -1;
+        self->hist[batch_lat_bucket(knapsack_now_ns() - t_start)]++;
+        pthread_mutex_lock(&pool->lock);
+        slot->done = 1;
+        pthread_cond_signal(&pool->done_cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    knapsack_context_destroy(ctx);
+    return NULL;
+}
+
+// 读入一个实例："n 容量" 之后跟 n 行 "重量 价值"。成功返回 1，正常读到文件尾返回 0，
+// 格式错误、实例不完整或内存不足返回 -1
+static int batch_read(FILE* in, BatchSlot* slot) {
+    int n;
+    double capacity;
+    int got = fscanf(in, "%d %lf", &n, &capacity);
+    if (got == EOF) return 0;
+    if (got != 2 || n < 0) return -1;
+    if (n > slot->cap) {
+        Item* items = (Item*)realloc(slot->items, n * sizeof(Item));
+        if (!items) return -1;
+        slot->items = items;
+        int* selected = (int*)realloc(slot->selected, n * sizeof(int));
+        if (!selected) return -1;
+        slot->selected = selected;
+        slot->cap = n;
+    }
+    for (int i = 0; i < n; i++) {
+        slot->items[i].id = i + 1;
+        if (fscanf(in, "%lf %lf", &slot->items[i].weight, &slot->items[i].value) != 2) return -1;
+    }
+    slot->n = n;
+    slot->capacity = capacity;
+    return 1;
+}
+
+// 输出一个实例的结果："最优价值 选中个数 选中物品编号..."，求解失败输出 -1
+static void batch_write(FILE* out, const BatchSlot* slot) {
+    if (slot->status != 0) {
+        fprintf(out, "-1\n");
+        return;
+    }
+    int count = 0;
+    for (int i = 0; i < slot->n; i++) count += slot->selected[i] != 0;
+    fprintf(out, "%.2f %d", slot->max_value, count);
+    for (int i = 0; i < slot->n; i++) {
+        if (slot->selected[i]) fprintf(out, " %d", slot->items[i].id);
+    }
+    fprintf(out, "\n");
+}
+
+static void batch_wait(BatchPool* pool, BatchSlot* slot) {
+    pthread_mutex_lock(&pool->lock);
+    while (!slot->done) pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int knapsack_batch_solve(FILE* in, FILE* out, int threads, KnapsackBatchStats* stats) {
+    if (threads <= 0) threads = cpu_count();
+    BatchPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.threads = threads;
+    pool.ring = threads * BATCH_RING_PER_THREAD;
+    pool.slots = (BatchSlot*)calloc(pool.ring, sizeof(BatchSlot));
+    pool.deques = (BatchDeque*)calloc(threads, sizeof(BatchDeque));
+    pool.workers = (BatchWorker*)calloc(threads, sizeof(BatchWorker));
+    int* deque_buf = (int*)malloc((size_t)threads * pool.ring * sizeof(int));
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (!pool.slots || !pool.deques || !pool.workers || !deque_buf || !tids) {
+        free(pool.slots);
+        free(pool.deques);
+        free(pool.workers);
+        free(deque_buf);
+        free(tids);
+        return -1;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work_cond, NULL);
+    pthread_cond_init(&pool.done_cond, NULL);
+    for (int t = 0; t < threads; t++) {
+        pool.deques[t].buf = deque_buf + (size_t)t * pool.ring;
+        pool.deques[t].size = pool.ring;
+        pthread_mutex_init(&pool.deques[t].lock, NULL);
+        pool.workers[t].pool = &pool;
+        pool.workers[t].id = t;
+        pthread_create(&tids[t], NULL, batch_worker, &pool.workers[t]);
+    }
+
+    uint64_t t_start = knapsack_now_ns();
+    long long next_read = 0, next_write = 0, failed = 0;
+    int read_status = 0;
+    while (1) {
+        if (next_read - next_write == pool.ring) { // 环满：先输出最老的实例，腾出槽位
+            BatchSlot* oldest = &pool.slots[next_write % pool.ring];
+            batch_wait(&pool, oldest);
+            batch_write(out, oldest);
+            failed += oldest->status != 0;
+            next_write++;
+        }
+        int s = (int)(next_read % pool.ring);
+        BatchSlot* slot = &pool.slots[s];
+        read_status = batch_read(in, slot);
+        if (read_status <= 0) break;
+        slot->done = 0;
+        __atomic_fetch_add(&pool.pending, 1, __ATOMIC_ACQ_REL);
+        batch_deque_push(&pool.deques[next_read % threads], s);
+        pthread_mutex_lock(&pool.lock);
+        pthread_cond_signal(&pool.work_cond);
+        pthread_mutex_unlock(&pool.lock);
+        next_read++;
+    }
+    while (next_write < next_read) {
+        BatchSlot* oldest = &pool.slots[next_write % pool.ring];
+        batch_wait(&pool, oldest);
+        batch_write(out, oldest);
+        failed += oldest->status != 0;
+        next_write++;
+    }
+    fflush(out);
+    uint64_t t_end = knapsack_now_ns();
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = 1;
+    pthread_cond_broadcast(&pool.work_cond);
+    pthread_mutex_unlock(&pool.lock);
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+
+    if (stats) {
+        unsigned long long hist[BATCH_LAT_BUCKETS] = {0};
+        for (int t = 0; t < threads; t++) {
+            for (int b = 0; b < BATCH_LAT_BUCKETS; b++) hist[b] += pool.workers[t].hist[b];
+        }
+        stats->instances = next_read;
+        stats->failed = failed;
+        stats->seconds = (t_end - t_start) / 1e9;
+        stats->per_second = stats->seconds > 0 ? next_read / stats->seconds : 0;
+        stats->p50_us = batch_percentile(hist, (unsigned long long)next_read, 0.50) / 1000.0;
+        stats->p99_us = batch_percentile(hist, (unsigned long long)next_read, 0.99) / 1000.0;
+        stats->in_flight = pool.ring;
+    }
+
+    for (int t = 0; t < threads; t++) pthread_mutex_destroy(&pool.deques[t].lock);
+    for (int i = 0; i < pool.ring; i++) {
+        free(pool.slots[i].items);
+        free(pool.slots[i].selected);
+    }
+    pthread_cond_destroy(&pool.work_cond);
+    pthread_cond_destroy(&pool.done_cond);
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.slots);
+    free(pool.deques);
+    free(pool.workers);
+    free(deque_buf);
+    free(tids);
+    return read_status < 0 ? 1 : 0;
+}
+
+// ---------------- CSV 读取 ----------------
+// 格式与程序输出的 items.csv 相同：可选的表头（允许 UTF-8 BOM），之后每行 "编号,重量,价值"，行尾可带 \r。
+// 整个文件读取用 mmap 映射后按换行切成若干段，先并行数行、再按前缀和把各段并行解析到同一个数组；
+// 流式读取每次读入一块（只处理其中完整的行，剩余部分留到下一块），每块同样并行解析
+#define CSV_MIN_BYTES_PER_THREAD (1 << 20) // 每个线程至少分到 1MB，太小时减少线程数
+#define CSV_STREAM_CHUNK ((size_t)64 << 20) // 流式读取默认每块 64MB
+
+typedef struct {
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} MappedFile;
+
+// 只读映射整个文件；空文件 data 为 NULL。失败返回 -1
+static int mapped_file_open(const char* path, MappedFile* map) {
+    memset(map, 0, sizeof(*map));
+#ifdef _WIN32
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file == INVALID_HANDLE_VALUE) return -1;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size)) {
+        CloseHandle(map->file);
+        return -1;
+    }
+    map->size = (size_t)size.QuadPart;
+    if (map->size == 0) return 0;
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping) map->data = (const char*)MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!map->data) {
+        if (map->mapping) CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return -1;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    map->size = (size_t)st.st_size;
+    if (map->size > 0) {
+        void* p = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(p, map->size, MADV_SEQUENTIAL);
+        map->data = (const char*)p;
+    }
+    close(fd); // 映射建立后即可关闭文件描述符
+#endif
+    return 0;
+}
+
+static void mapped_file_close(MappedFile* map) {
+#ifdef _WIN32
+    if (map->data) UnmapViewOfFile(map->data);
+    if (map->mapping) CloseHandle(map->mapping);
+    if (map->file && map->file != INVALID_HANDLE_VALUE) CloseHandle(map->file);
+#else
+    if (map->data) munmap((void*)map->data, map->size);
+#endif
+    memset(map, 0, sizeof(*map));
+}
+
+static const double csv_pow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 解析一个浮点数，返回解析结束的位置，失败返回 NULL。
+// 有效数字不超过 2^53 且十进制指数在 ±22 以内时，尾数与 10 的幂都能精确表示，一次乘除即得正确舍入的结果；
+// 其余情况交给 strtod
+static const char* csv_parse_double(const char* p, const char* end, double* out) {
+    const char* start = p;
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    uint64_t mant = 0;
+    int digits = 0, exp10 = 0, any = 0;
+    while (p < end && (unsigned)(*p - '0') < 10) {
+        if (digits < 19) {
+            mant = mant * 10 + (unsigned)(*p - '0');
+            if (mant) digits++;
+        } else {
+            exp10++;
+        }
+        p++;
+        any = 1;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && (unsigned)(*p - '0') < 10) {
+            if (digits < 19) {
+                mant = mant * 10 + (unsigned)(*p - '0');
+                if (mant) digits++;
+                exp10--;
+            }
+            p++;
+            any = 1;
+        }
+    }
+    if (!any) return NULL;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        int eneg = 0, e = 0, edigits = 0;
+        if (q < end && (*q == '-' || *q == '+')) {
+            eneg = *q == '-';
+            q++;
+        }
+        while (q < end && (unsigned)(*q - '0') < 10) {
+            if (e < 10000) e = e * 10 + (*q - '0');
+            q++;
+            edigits++;
+        }
+        if (edigits > 0) {
+            exp10 += eneg ? -e : e;
+            p = q;
+        }
+    }
+    if (mant < ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        double x = (double)mant;
+        x = exp10 < 0 ? x / csv_pow10[-exp10] : x * csv_pow10[exp10];
+        *out = neg ? -x : x;
+        return p;
+    }
+    char buf[128];
+    size_t len = (size_t)(p - start);
+    if (len >= sizeof(buf)) return NULL;
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    *out = strtod(buf, NULL);
+    return p;
+}
+
+// 解析一行 "编号,重量,价值"（line_end 不含换行符），成功返回 1
+static int csv_parse_line(const char* p, const char* line_end, Item* item) {
+    while (p < line_end && (*p == ' ' || *p == '\t')) p++;
+    int id = 0, any = 0;
+    while (p < line_end && (unsigned)(*p - '0') < 10) {
+        id = id * 10 + (*p - '0');
+        p++;
+        any = 1;
+    }
+    if (!any || p >= line_end || *p != ',') return 0;
+    p = csv_parse_double(p + 1, line_end, &item->weight);
+    if (!p || p >= line_end || *p != ',') return 0;
+    p = csv_parse_double(p + 1, line_end, &item->value);
+    if (!p) return 0;
+    item->id = id;
+    return 1;
+}
+
+// 跳过 UTF-8 BOM 和表头行（第一行不以数字开头时视为表头）
+static const char* csv_skip_header(const char* p, const char* end) {
+    if (end - p >= 3 && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF) p += 3;
+    if (p < end && (unsigned)(*p - '0') >= 10) {
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        p = nl ? nl + 1 : end;
+    }
+    return p;
+}
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    Item* out;      // 解析阶段写入的位置
+    long long rows; // 计数阶段：行数上限；解析阶段：成功解析的行数
+    long long skipped;
+} CsvRange;
+
+static void* csv_count_worker(void* arg) {
+    CsvRange* r = (CsvRange*)arg;
+    long long rows = 0;
+    const char* p = r->begin;
+    while (p < r->end) {
+        const char* nl = (const char*)memchr(p, '\n', r->end - p);
+        rows++;
+        if (!nl) break;
+        p = nl + 1;
+    }
+    r->rows = rows;
+    return NULL;
+}
+
+static void* csv_parse_worker(void* arg) {
+    CsvRange* r = (CsvRange*)arg;
+    long long rows = 0, skipped = 0;
+    const char* p = r->begin;
+    while (p < r->end) {
+        const char* nl = (const char*)memchr(p, '\n', r->end - p);
+        const char* line_end = nl ? nl : r->end;
+        const char* q = line_end;
+        if (q > p && q[-1] == '\r') q--;
+        if (q > p) {
+            if (csv_parse_line(p, q, &r->out[rows])) rows++;
+            else skipped++;
+        }
+        p = nl ? nl + 1 : r->end;
+    }
+    r->rows = rows;
+    r->skipped = skipped;
+    return NULL;
+}
+
+static void csv_run(CsvRange* ranges, int threads, void* (*fn)(void*)) {
+    pthread_t tids[64];
+    for (int t = 1; t < threads; t++) pthread_create(&tids[t], NULL, fn, &ranges[t]);
+    fn(&ranges[0]); // 主线程负责第一段
+    for (int t = 1; t < threads; t++) pthread_join(tids[t], NULL);
+}
+
+// 并行解析 [begin, end) 中的行，结果写入 *items（容量 *cap 不够时扩容）。
+// 返回解析出的物品数，*skipped 累加格式错误的行数；内存不足或超过 int 范围返回 -1
+static long long csv_parse_block(const char* begin, const char* end, int threads, Item** items, long long* cap,
+                                 long long* skipped) {
+    size_t bytes = (size_t)(end - begin);
+    if (threads <= 0) threads = cpu_count();
+    if (threads > 64) threads = 64;
+    if ((size_t)threads > bytes / CSV_MIN_BYTES_PER_THREAD) threads = (int)(bytes / CSV_MIN_BYTES_PER_THREAD);
+    if (threads < 1) threads = 1;
+
+    // 按字节均分，每段的起点推到下一个换行之后，保证行不会被切开
+    CsvRange ranges[64];
+    const char* prev = begin;
+    for (int t = 0; t < threads; t++) {
+        const char* b = prev;
+        const char* e = t == threads - 1 ? end : begin + bytes / threads * (t + 1);
+        if (e < b) e = b;
+        if (e < end) {
+            const char* nl = (const char*)memchr(e, '\n', end - e);
+            e = nl ? nl + 1 : end;
+        }
+        ranges[t].begin = b;
+        ranges[t].end = e;
+        prev = e;
+    }
+    csv_run(ranges, threads, csv_count_worker);
+
+    long long total = 0;
+    for (int t = 0; t < threads; t++) total += ranges[t].rows;
+    if (total > 0x7fffffff) return -1;
+    if (total > *cap) {
+        Item* grown = (Item*)realloc(*items, (size_t)total * sizeof(Item));
+        if (!grown) return -1;
+        *items = grown;
+        *cap = total;
+    }
+    long long offset = 0;
+    for (int t = 0; t < threads; t++) {
+        ranges[t].out = *items + offset;
+        offset += ranges[t].rows;
+    }
+    csv_run(ranges, threads, csv_parse_worker);
+
+    // 各段实际解析的行数可能少于行数上限（空行、格式错误），把后面的段前移补齐
+    long long count = 0;
+    for (int t = 0; t < threads; t++) {
+        if (ranges[t].out != *items + count) memmove(*items + count, ranges[t].out, ranges[t].rows * sizeof(Item));
+        count += ranges[t].rows;
+        *skipped += ranges[t].skipped;
+    }
+    return count;
+}
+
+static void csv_finish_stats(KnapsackLoadStats* stats, long long rows, long long skipped, size_t bytes,
+                             uint64_t t_start) {
+    if (!stats) return;
+    stats->rows = rows;
+    stats->skipped = skipped;
+    stats->bytes = bytes;
+    stats->seconds = (knapsack_now_ns() - t_start) / 1e9;
+    stats->mb_per_s = stats->seconds > 0 ? bytes / (1024.0 * 1024.0) / stats->seconds : 0;
+}
+
+Item* knapsack_load_csv(const char* path, int threads, int* count, KnapsackLoadStats* stats) {
+    uint64_t t_start = knapsack_now_ns();
+    *count = 0;
+    MappedFile map;
+    if (mapped_file_open(path, &map) != 0) return NULL;
+    Item* items = NULL;
+    long long cap = 0, skipped = 0, rows = 0;
+    if (map.data) {
+        const char* begin = csv_skip_header(map.data, map.data + map.size);
+        rows = csv_parse_block(begin, map.data + map.size, threads, &items, &cap, &skipped);
+    }
+    size_t bytes = map.size;
+    mapped_file_close(&map);
+    if (rows < 0) {
+        free(items);
+        return NULL;
+    }
+    if (!items) items = (Item*)malloc(sizeof(Item)); // 空文件也返回一个可释放的数组
+    *count = (int)rows;
+    csv_finish_stats(stats, rows, skipped, bytes, t_start);
+    return items;
+}
+
+long long knapsack_stream_csv(const char* path, size_t chunk_bytes, int threads, KnapsackItemSink sink, void* user,
+                              KnapsackLoadStats* stats) {
+    uint64_t t_start = knapsack_now_ns();
+    if (chunk_bytes == 0) chunk_bytes = CSV_STREAM_CHUNK;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return -1;
+    char* buf = (char*)malloc(chunk_bytes);
+    Item* items = NULL;
+    long long cap = 0, total = 0, skipped = 0;
+    size_t bytes = 0, filled = 0;
+    int first = 1, eof = 0, failed = buf == NULL;
+    while (!failed && !eof) {
+        size_t got = fread(buf + filled, 1, chunk_bytes - filled, fp);
+        bytes += got;
+        filled += got;
+        eof = filled < chunk_bytes;
+        const char* begin = buf;
+        const char* end = buf + filled;
+        if (first) {
+            // 表头必须完整地出现在第一块中
+            begin = csv_skip_header(begin, end);
+            first = 0;
+        }
+        if (!eof) { // 只处理完整的行，最后一个换行之后的部分留到下一块
+            const char* last = end;
+            while (last > begin && last[-1] != '\n') last--;
+            if (last == begin) { // 一行比整块还长：丢弃已跳过的表头，扩大缓冲区
+                size_t skip = (size_t)(begin - buf);
+                filled -= skip;
+                memmove(buf, begin, filled);
+                char* grown = (char*)realloc(buf, chunk_bytes * 2);
+                if (!grown) {
+                    failed = 1;
+                    break;
+                }
+                buf = grown;
+                chunk_bytes *= 2;
+                continue;
+            }
+            end = last;
+        }
+        long long rows = csv_parse_block(begin, end, threads, &items, &cap, &skipped);
+        if (rows < 0) {
+            failed = 1;
+            break;
+        }
+        total += rows;
+        if (rows > 0 && sink(items, (int)rows, user) != 0) break;
+        filled = (size_t)(buf + filled - end);
+        memmove(buf, end, filled);
+    }
+    fclose(fp);
+    free(buf);
+    free(items);
+    if (failed) return -1;
+    csv_finish_stats(stats, total, skipped, bytes, t_start);
+    return total;
+}
+
+// ---------------- 列式二进制实例文件 ----------------
+// 文件头 128 字节，之后是按 64 字节对齐的列：编号(int32)、重量(double)、价值(double)、可选的 ×100 整数重量(int32)。
+// 数据按本机字节序存放，读取时整个文件 mmap 后直接把列指针指向映射区，不解析也不复制；
+// 版本号按本机字节序读出不等于 KSB_VERSION 时（版本不同或字节序不同）拒绝打开
+#define KSB_MAGIC "KNAPBIN"
+#define KSB_VERSION 1
+#define KSB_ALIGN 64
+#define KSB_CHUNK 65536 // 写文件时每次转换的物品数
+
+typedef struct {
+    char magic[8];          // "KNAPBIN\0"
+    uint32_t version;
+    uint32_t flags;         // KNAPSACK_BIN_INT_WEIGHT
+    uint64_t count;         // 物品数
+    double capacity;        // 背包容量
+    int32_t scale;          // 整数重量列的放大倍数
+    uint32_t header_size;
+    uint64_t id_offset;     // 各列相对文件开头的偏移
+    uint64_t weight_offset;
+    uint64_t value_offset;
+    uint64_t int_weight_offset; // 没有整数重量列时为 0
+    uint64_t reserved[7];
+} KsbHeader;
+
+#ifdef _WIN32
+#define ksb_fseek _fseeki64
+#else
+#define ksb_fseek fseeko
+#endif
+
+static uint64_t ksb_align(uint64_t x) {
+    return (x + KSB_ALIGN - 1) / KSB_ALIGN * KSB_ALIGN;
+}
+
+static void ksb_layout(KsbHeader* h, long long n, double capacity, int flags) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, KSB_MAGIC, sizeof(KSB_MAGIC));
+    h->version = KSB_VERSION;
+    h->flags = (uint32_t)flags;
+    h->count = (uint64_t)n;
+    h->capacity = capacity;
+    h->scale = 100; // 与 dynamic_programming 的整数化一致
+    h->header_size = sizeof(KsbHeader);
+    h->id_offset = ksb_align(sizeof(KsbHeader));
+    h->weight_offset = ksb_align(h->id_offset + n * sizeof(int32_t));
+    h->value_offset = ksb_align(h->weight_offset + n * sizeof(double));
+    h->int_weight_offset = (flags & KNAPSACK_BIN_INT_WEIGHT) ? ksb_align(h->value_offset + n * sizeof(double)) : 0;
+}
+
+static uint64_t ksb_file_size(const KsbHeader* h) {
+    if (h->int_weight_offset) return h->int_weight_offset + h->count * sizeof(int32_t);
+    return h->value_offset + h->count * sizeof(double);
+}
+
+// 列 [offset, offset + count*elem) 是否在 [start, size) 之内；先比较再相乘，不会溢出
+static int ksb_column_fits(uint64_t offset, uint64_t count, uint64_t elem, uint64_t start, uint64_t size) {
+    return offset % KSB_ALIGN == 0 && offset >= start && offset <= size && count <= (size - offset) / elem;
+}
+
+// 检查文件头：各列都要在映射区内，并且按 编号、重量、价值、整数重量 的顺序依次排列、互不重叠
+static int ksb_header_valid(const KsbHeader* h, uint64_t size) {
+    if (size < sizeof(KsbHeader) || memcmp(h->magic, KSB_MAGIC, sizeof(KSB_MAGIC)) != 0 ||
+        h->version != KSB_VERSION || h->count > 0x7fffffff) {
+        return 0;
+    }
+    uint64_t n = h->count;
+    if (!ksb_column_fits(h->id_offset, n, sizeof(int32_t), sizeof(KsbHeader), size)) return 0;
+    uint64_t end = h->id_offset + n * sizeof(int32_t);
+    if (!ksb_column_fits(h->weight_offset, n, sizeof(double), end, size)) return 0;
+    end = h->weight_offset + n * sizeof(double);
+    if (!ksb_column_fits(h->value_offset, n, sizeof(double), end, size)) return 0;
+    end = h->value_offset + n * sizeof(double);
+    if (h->int_weight_offset && !ksb_column_fits(h->int_weight_offset, n, sizeof(int32_t), end, size)) return 0;
+    return 1;
+}
+
+// 把 items[0..n) 写到各列的第 first 个位置起，列数据经 buf（KSB_CHUNK 个 double）分批转换
+static int ksb_write_columns(FILE* fp, const KsbHeader* h, long long first, const Item* items, int n, double* buf) {
+    int32_t* ibuf = (int32_t*)buf;
+    for (int base = 0; base < n; base += KSB_CHUNK) {
+        int m = n - base < KSB_CHUNK ? n - base : KSB_CHUNK;
+        const Item* it = items + base;
+        long long pos = first + base;
+        for (int i = 0; i < m; i++) ibuf[i] = it[i].id;
+        if (ksb_fseek(fp, (long long)h->id_offset + pos * (long long)sizeof(int32_t), SEEK_SET) != 0 ||
+            fwrite(ibuf, sizeof(int32_t), m, fp) != (size_t)m) return -1;
+        for (int i = 0; i < m; i++) buf[i] = it[i].weight;
+        if (ksb_fseek(fp, (long long)h->weight_offset + pos * (long long)sizeof(double), SEEK_SET) != 0 ||
+            fwrite(buf, sizeof(double), m, fp) != (size_t)m) return -1;
+        for (int i = 0; i < m; i++) buf[i] = it[i].value;
+        if (ksb_fseek(fp, (long long)h->value_offset + pos * (long long)sizeof(double), SEEK_SET) != 0 ||
+            fwrite(buf, sizeof(double), m, fp) != (size_t)m) return -1;
+        if (h->int_weight_offset) {
+            for (int i = 0; i < m; i++) ibuf[i] = (int32_t)(it[i].weight * h->scale + 0.5);
+            if (ksb_fseek(fp, (long long)h->int_weight_offset + pos * (long long)sizeof(int32_t), SEEK_SET) != 0 ||
+                fwrite(ibuf, sizeof(int32_t), m, fp) != (size_t)m) return -1;
+        }
+    }
+    return 0;
+}
+
+// 写文件头，并把文件扩到完整大小（列之间的对齐空隙补 0）
+static FILE* ksb_create(const char* path, const KsbHeader* h) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return NULL;
+    uint64_t size = ksb_file_size(h);
+    if (fwrite(h, sizeof(*h), 1, fp) != 1 || ksb_fseek(fp, (long long)size - 1, SEEK_SET) != 0 || fputc(0, fp) == EOF) {
+        fclose(fp);
+        remove(path);
+        return NULL;
+    }
+    return fp;
+}
+
+int knapsack_save_binary(const char* path, const Item* items, int n, double capacity, int flags) {
+    KsbHeader h;
+    ksb_layout(&h, n, capacity, flags);
+    double* buf = (double*)malloc(KSB_CHUNK * sizeof(double));
+    FILE* fp = buf ? ksb_create(path, &h) : NULL;
+    if (!fp) {
+        free(buf);
+        return -1;
+    }
+    int status = ksb_write_columns(fp, &h, 0, items, n, buf);
+    if (fclose(fp) != 0) status = -1;
+    free(buf);
+    if (status != 0) remove(path);
+    return status;
+}
+
+typedef struct {
+    FILE* fp;
+    const KsbHeader* header;
+    long long written;
+    double* buf;
+} KsbConvert;
+
+static int ksb_count_sink(const Item* items, int count, void* user) {
+    (void)items;
+    *(long long*)user += count;
+    return 0;
+}
+
+static int ksb_convert_sink(const Item* items, int count, void* user) {
+    KsbConvert* cv = (KsbConvert*)user;
+    if (cv->written + count > (long long)cv->header->count) return 1; // 文件在两遍读取之间变长了
+    if (ksb_write_columns(cv->fp, cv->header, cv->written, items, count, cv->buf) != 0) return 1;
+    cv->written += count;
+    return 0;
+}
+
+// 先流式读一遍确定物品数（列的位置依赖于它），再流式读一遍把每块写到各列
+int knapsack_convert_csv(const char* csv_path, const char* bin_path, double capacity, int flags,
+                         KnapsackLoadStats* stats) {
+    long long n = 0;
+    if (knapsack_stream_csv(csv_path, 0, 0, ksb_count_sink, &n, NULL) < 0 || n > 0x7fffffff) return -1;
+    KsbHeader h;
+    ksb_layout(&h, n, capacity, flags);
+    KsbConvert cv;
+    cv.buf = (double*)malloc(KSB_CHUNK * sizeof(double));
+    cv.fp = cv.buf ? ksb_create(bin_path, &h) : NULL;
+    cv.header = &h;
+    cv.written = 0;
+    if (!cv.fp) {
+        free(cv.buf);
+        return -1;
+    }
+    long long rows = knapsack_stream_csv(csv_path, 0, 0, ksb_convert_sink, &cv, stats);
+    int status = rows == n && cv.written == n ? 0 : -1;
+    if (fclose(cv.fp) != 0) status = -1;
+    free(cv.buf);
+    if (status != 0) remove(bin_path);
+    return status;
+}
+
+int knapsack_open_binary(const char* path, KnapsackColumns* cols) {
+    memset(cols, 0, sizeof(*cols));
+    MappedFile* map = (MappedFile*)malloc(sizeof(MappedFile));
+    if (!map) return -1;
+    if (mapped_file_open(path, map) != 0) {
+        free(map);
+        return -1;
+    }
+    const KsbHeader* h = (const KsbHeader*)map->data;
+    if (!ksb_header_valid(h, map->size)) {
+        mapped_file_close(map);
+        free(map);
+        return -1;
+    }
+    cols->n = (int)h->count;
+    cols->capacity = h->capacity;
+    cols->scale = h->scale;
+    cols->id = (const int32_t*)(map->data + h->id_offset);
+    cols->weight = (const double*)(map->data + h->weight_offset);
+    cols->value = (const double*)(map->data + h->value_offset);
+    cols->int_weight = h->int_weight_offset ? (const int32_t*)(map->data + h->int_weight_offset) : NULL;
+    cols->map = map;
+    return 0;
+}
+
+void knapsack_close_binary(KnapsackColumns* cols) {
+    if (cols->map) {
+        mapped_file_close((MappedFile*)cols->map);
+        free(cols->map);
+    }
+    memset(cols, 0, sizeof(*cols));
+}
+
+// ---------------- 列式求解 ----------------
+// 直接读取列数据，不先拼成 Item 数组；有 ×100 整数重量列时 DP 与核心算法直接使用，省去取整
+
+void greedy_fast_columns(const KnapsackColumns* cols, double capacity, int* selected, double* max_value) {
+    int n = cols->n;
+    *max_value = 0;
+    if (n <= 0) return;
+    RatioEntry* e = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+    for (int i = 0; i < n; i++) {
+        e[i].ratio = cols->value[i] / cols->weight[i];
+        e[i].weight = cols->weight[i];
+        e[i].value = cols->value[i];
+        e[i].idx = i;
+        selected[i] = 0;
+    }
+    greedy_fast_entries(e, n, capacity, selected, max_value);
+    scratch_free(e);
+}
+
+void core_solver_columns(const KnapsackColumns* cols, double capacity, int* selected, double* max_value) {
+    int n = cols->n;
+    int scale = 100;
+    int int_capacity = (int)(capacity * scale + 0.5);
+    const int32_t* iw = cols->scale == scale ? cols->int_weight : NULL;
+    *max_value = 0;
+    core_last_size = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    RatioEntry* e = (RatioEntry*)scratch_malloc(n * sizeof(RatioEntry));
+    for (int i = 0; i < n; i++) {
+        int w = iw ? iw[i] : (int)(cols->weight[i] * scale + 0.5);
+        e[i].weight = w;
+        e[i].value = cols->value[i];
+        e[i].ratio = w > 0 ? cols->value[i] / w : DBL_MAX;
+        e[i].idx = i;
+        selected[i] = 0;
+    }
+    core_solve_entries(e, n, int_capacity, selected, max_value);
+    scratch_free(e);
+}
+
+void dynamic_programming_columns(const KnapsackColumns* cols, double capacity, int* selected, double* max_value,
+                                 int threads) {
+    int n = cols->n;
+    int scale = 100;
+    int int_capacity = (int)(capacity * scale + 0.5);
+    *max_value = 0;
+    knapsack_last_status = KS_STATUS_OK;
+    if (n <= 0 || int_capacity < 0) return;
+    const int* int_weight = cols->scale == scale ? (const int*)cols->int_weight : NULL;
+    int* converted = NULL;
+    if (!int_weight) {
+        converted = (int*)scratch_malloc(n * sizeof(int));
+        for (int i = 0; i < n; i++) converted[i] = (int)(cols->weight[i] * scale + 0.5);
+        int_weight = converted;
+    }
+    double best = dp_solve_arrays(int_weight, cols->value, n, int_capacity, selected, threads);
+    if (best < 0) knapsack_last_status = KS_STATUS_NO_MEMORY;
+    else *max_value = best;
+    scratch_free(converted);
+}
+// ---------------- 实例生成 ----------------
+// Pisinger 的经典难例分类。除不相关类沿用原来的范围（重量 1.00~100.00，价值 100.00~1000.00）外，
+// 数据先按百分之一为单位生成整数（范围 R = 10000，即 0.01~100.00），再除以 100，整数化后与 DP 的 ×100 完全一致。
+// 每 GEN_CHUNK 个物品为一段，段的随机数种子由 (seed, 段号) 经 splitmix64 得到，各段可由不同线程生成，
+// 结果只取决于 seed，与线程数无关
+#define GEN_RANGE 10000          // 整数数据范围 R（百分之一）
+#define GEN_CHUNK 65536          // 每段物品数
+#define GEN_MIN_CHUNKS_PER_THREAD 4
+#define GEN_SPANNER_SIZE 2       // 张成集大小 v
+#define GEN_SPANNER_MULT 10      // 张成倍数上限 m
+
+static uint64_t gen_splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void knapsack_rng_seed(KnapsackRng* rng, uint64_t seed) {
+    for (int k = 0; k < 4; k++) rng->s[k] = gen_splitmix64(&seed);
+}
+
+static inline uint64_t gen_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// xoshiro256**
+uint64_t knapsack_rng_next(KnapsackRng* rng) {
+    uint64_t* s = rng->s;
+    uint64_t result = gen_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = gen_rotl(s[3], 45);
+    return result;
+}
+
+// [lo, hi] 上的均匀整数：取高 32 位做乘法映射（不用取模，hi - lo 不超过 2^32 - 1）
+int64_t knapsack_rng_range(KnapsackRng* rng, int64_t lo, int64_t hi) {
+    uint64_t span = (uint64_t)(hi - lo) + 1;
+    return lo + (int64_t)(((knapsack_rng_next(rng) >> 32) * span) >> 32);
+}
+
+const char* knapsack_gen_class_name(KnapsackInstanceClass cls) {
+    static const char* names[KS_GEN_CLASS_COUNT] = {
+        "uncorrelated", "weak", "strong", "inverse", "subset_sum", "similar", "spanner"
+    };
+    return cls >= 0 && cls < KS_GEN_CLASS_COUNT ? names[cls] : "";
+}
+
+typedef struct {
+    Item* items;
+    int n;
+    KnapsackInstanceClass cls;
+    uint64_t seed;
+    int first_chunk;                       // 负责第 first_chunk, first_chunk + stride, ... 段
+    int stride;
+    const int64_t* spanner;                // 张成集：依次为 (重量, 价值)，单位为百分之一
+} GenTask;
+
+// 生成一个物品的 (重量, 价值)，单位为百分之一
+static void gen_one(KnapsackRng* rng, KnapsackInstanceClass cls, const int64_t* spanner, int64_t* w, int64_t* p) {
+    const int64_t r = GEN_RANGE;
+    switch (cls) {
+    case KS_GEN_WEAKLY_CORRELATED:
+        *w = knapsack_rng_range(rng, 1, r);
+        *p = knapsack_rng_range(rng, *w - r / 10 > 1 ? *w - r / 10 : 1, *w + r / 10);
+        break;
+    case KS_GEN_STRONGLY_CORRELATED:
+        *w = knapsack_rng_range(rng, 1, r);
+        *p = *w + r / 10;
+        break;
+    case KS_GEN_INVERSE_STRONGLY:
+        *p = knapsack_rng_range(rng, 1, r);
+        *w = *p + r / 10;
+        break;
+    case KS_GEN_SUBSET_SUM:
+        *w = knapsack_rng_range(rng, 1, r);
+        *p = *w;
+        break;
+    case KS_GEN_SIMILAR_WEIGHTS: // 重量都在 99.00~100.00 之间，价值 0.01~10.00
+        *w = knapsack_rng_range(rng, r - 100, r);
+        *p = knapsack_rng_range(rng, 1, 1000);
+        break;
+    case KS_GEN_SPANNER: { // 随机取一个张成物品乘以 1~m 倍
+        int k = (int)knapsack_rng_range(rng, 0, GEN_SPANNER_SIZE - 1);
+        int64_t a = knapsack_rng_range(rng, 1, GEN_SPANNER_MULT);
+        *w = a * spanner[2 * k];
+        *p = a * spanner[2 * k + 1];
+        break;
+    }
+    default: // 不相关：与原 generate_items 的范围相同
+        *w = knapsack_rng_range(rng, 100, 10000);
+        *p = knapsack_rng_range(rng, 10000, 100000);
+        break;
+    }
+}
+
+static void* gen_worker(void* arg) {
+    GenTask* task = (GenTask*)arg;
+    int chunks = (task->n + GEN_CHUNK - 1) / GEN_CHUNK;
+    for (int c = task->first_chunk; c < chunks; c += task->stride) {
+        KnapsackRng rng;
+        knapsack_rng_seed(&rng, task->seed ^ ((uint64_t)(c + 1) * 0xD1B54A32D192ED03ULL));
+        int end = c == chunks - 1 ? task->n : (c + 1) * GEN_CHUNK;
+        for (int i = c * GEN_CHUNK; i < end; i++) {
+            int64_t w, p;
+            gen_one(&rng, task->cls, task->spanner, &w, &p);
+            task->items[i].id = i + 1;
+            task->items[i].weight = w / 100.0;
+            task->items[i].value = p / 100.0;
+        }
+    }
+    return NULL;
+}
+
+int knapsack_generate(Item* items, int n, KnapsackInstanceClass cls, uint64_t seed, int threads) {
+    if (n < 0 || (n > 0 && !items) || cls < 0 || cls >= KS_GEN_CLASS_COUNT) return -1;
+    // 张成集：按强相关生成 v 个物品，再缩小为 ceil(2w/m)、ceil(2p/m)
+    int64_t spanner[2 * GEN_SPANNER_SIZE];
+    KnapsackRng rng;
+    knapsack_rng_seed(&rng, seed);
+    for (int k = 0; k < GEN_SPANNER_SIZE; k++) {
+        int64_t w, p;
+        gen_one(&rng, KS_GEN_STRONGLY_CORRELATED, NULL, &w, &p);
+        spanner[2 * k] = (2 * w + GEN_SPANNER_MULT - 1) / GEN_SPANNER_MULT;
+        spanner[2 * k + 1] = (2 * p + GEN_SPANNER_MULT - 1) / GEN_SPANNER_MULT;
+    }
+
+    int chunks = (n + GEN_CHUNK - 1) / GEN_CHUNK;
+    if (threads <= 0) threads = cpu_count();
+    if (threads > 64) threads = 64;
+    if (threads > chunks / GEN_MIN_CHUNKS_PER_THREAD) threads = chunks / GEN_MIN_CHUNKS_PER_THREAD;
+    if (threads < 1) threads = 1;
+    GenTask tasks[64];
+    pthread_t tids[64];
+    for (int t = 0; t < threads; t++) {
+        tasks[t].items = items;
+        tasks[t].n = n;
+        tasks[t].cls = cls;
+        tasks[t].seed = seed;
+        tasks[t].first_chunk = t;
+        tasks[t].stride = threads;
+        tasks[t].spanner = spanner;
+    }
+    for (int t = 1; t < threads; t++) pthread_create(&tids[t], NULL, gen_worker, &tasks[t]);
+    gen_worker(&tasks[0]);
+    for (int t = 1; t < threads; t++) pthread_join(tids[t], NULL);
+    return 0;
+}
+// ---------------- 增量求解 ----------------
+// DP 表按物品一行一行向下推进，新物品只需在最后一行上再推一行（O(W)）。保存的内容：
+//   最后一行（容量 0..W 的最优值，行单调不减，任意 W' <= W 的最优值直接查表）；
+//   每个物品一行选择位图（n*W/8 字节），用于重建任意 W' 下的选择；
+//   每 INC_CHECKPOINT_ROWS 个物品保存一次整行（检查点）。
+// 删除第 p 个物品时，前 p 个物品的行不变，从 p 之前最近的检查点起重放其后的物品，代价 O((n - p) * W)，
+// 删除最近加入的物品只需重放很少几行。价值按 ×100 存为 int64，与整数DP相同，不会溢出也没有舍入误差
+#define INC_CHECKPOINT_ROWS 64 // 检查点间隔（行）
+
+struct KnapsackIncremental {
+    int cap;               // 整数化的最大容量 W
+    size_t words;          // 每行选择位图的字数
+    DpIntEngine engine;
+    Item* items;           // 按加入顺序
+    int* weights;          // 整数化重量
+    int64_t* values;       // 整数化价值
+    int n;
+    int items_cap;         // 以上数组及位图的容量（物品数）
+    uint64_t* keep;        // items_cap * words 个字
+    int64_t* last;         // 最后一行
+    int64_t* tmp;          // 推进时的临时行
+    int64_t* checkpoints;  // 第 k 个检查点为放入前 k*INC_CHECKPOINT_ROWS 个物品后的行（第 0 个为全 0）
+    int checkpoint_cap;    // 检查点数组容量（个）
+};
+
+KnapsackIncremental* knapsack_inc_create(double max_capacity) {
+    int cap = (int)(max_capacity * 100 + 0.5);
+    if (cap < 0) return NULL;
+    KnapsackIncremental* inc = (KnapsackIncremental*)calloc(1, sizeof(KnapsackIncremental));
+    if (!inc) return NULL;
+    inc->cap = cap;
+    inc->words = ((size_t)cap + 64) / 64;
+    dpi_engine_init(&inc->engine, 64);
+    inc->last = (int64_t*)calloc((size_t)cap + 1, sizeof(int64_t));
+    inc->tmp = (int64_t*)malloc(((size_t)cap + 1) * sizeof(int64_t));
+    inc->checkpoint_cap = 1;
+    inc->checkpoints = (int64_t*)calloc((size_t)cap + 1, sizeof(int64_t));
+    if (!inc->last || !inc->tmp || !inc->checkpoints) {
+        knapsack_inc_destroy(inc);
+        return NULL;
+    }
+    return inc;
+}
+
+void knapsack_inc_destroy(KnapsackIncremental* inc) {
+    if (!inc) return;
+    free(inc->items);
+    free(inc->weights);
+    free(inc->values);
+    free(inc->keep);
+    free(inc->last);
+    free(inc->tmp);
+    free(inc->checkpoints);
+    free(inc);
+}
+
+// 保证能再放入一个物品（物品数组、位图、检查点按倍数扩容）
+static int inc_reserve(KnapsackIncremental* inc) {
+    if (inc->n == inc->items_cap) {
+        int new_cap = inc->items_cap ? inc->items_cap * 2 : 64;
+        Item* items = (Item*)realloc(inc->items, new_cap * sizeof(Item));
+        if (!items) return -1;
+        inc->items = items;
+        int* weights = (int*)realloc(inc->weights, new_cap * sizeof(int));
+        if (!weights) return -1;
+        inc->weights = weights;
+        int64_t* values = (int64_t*)realloc(inc->values, new_cap * sizeof(int64_t));
+        if (!values) return -1;
+        inc->values = values;
+        uint64_t* keep = (uint64_t*)realloc(inc->keep, (size_t)new_cap * inc->words * sizeof(uint64_t));
+        if (!keep) return -1;
+        inc->keep = keep;
+        inc->items_cap = new_cap;
+    }
+    int need = (inc->n + 1) / INC_CHECKPOINT_ROWS + 1;
+    if (need > inc->checkpoint_cap) {
+        int new_cap = inc->checkpoint_cap * 2 > need ? inc->checkpoint_cap * 2 : need;
+        int64_t* cps = (int64_t*)realloc(inc->checkpoints, (size_t)new_cap * (inc->cap + 1) * sizeof(int64_t));
+        if (!cps) return -1;
+        inc->checkpoints = cps;
+        inc->checkpoint_cap = new_cap;
+    }
+    return 0;
+}
+
+// 把第 i 个物品推进到 last 行之上（last 为前 i 个物品的行），必要时保存检查点
+static void inc_push_row(KnapsackIncremental* inc, int i) {
+    uint64_t* keep = inc->keep + (size_t)i * inc->words;
+    memset(keep, 0, inc->words * sizeof(uint64_t));
+    dpi_row_update(&inc->engine, (const char*)inc->last, (char*)inc->tmp, inc->cap, inc->weights[i], inc->values[i], keep);
+    int64_t* t = inc->last;
+    inc->last = inc->tmp;
+    inc->tmp = t;
+    if ((i + 1) % INC_CHECKPOINT_ROWS == 0) {
+        memcpy(inc->checkpoints + (size_t)((i + 1) / INC_CHECKPOINT_ROWS) * (inc->cap + 1), inc->last,
+               ((size_t)inc->cap + 1) * sizeof(int64_t));
+    }
+}
+
+int knapsack_inc_add(KnapsackIncremental* inc, const Item* item) {
+    if (!inc || !item || inc_reserve(inc) != 0) return -1;
+    int i = inc->n;
+    double v = item->value * 100;
+    inc->items[i] = *item;
+    inc->weights[i] = (int)(item->weight * 100 + 0.5);
+    inc->values[i] = v > 0 ? (int64_t)(v + 0.5) : 0;
+    inc_push_row(inc, i);
+    inc->n++;
+    return 0;
+}
+
+int knapsack_inc_remove(KnapsackIncremental* inc, int id) {
+    if (!inc) return -1;
+    int p = inc->n - 1;
+    while (p >= 0 && inc->items[p].id != id) p--; // 从后往前找，最近加入的物品删除最快
+    if (p < 0) return -1;
+    int tail = inc->n - 1 - p;
+    memmove(inc->items + p, inc->items + p + 1, tail * sizeof(Item));
+    memmove(inc->weights + p, inc->weights + p + 1, tail * sizeof(int));
+    memmove(inc->values + p, inc->values + p + 1, tail * sizeof(int64_t));
+    inc->n--;
+    int start = p / INC_CHECKPOINT_ROWS * INC_CHECKPOINT_ROWS;
+    memcpy(inc->last, inc->checkpoints + (size_t)(start / INC_CHECKPOINT_ROWS) * (inc->cap + 1),
+           ((size_t)inc->cap + 1) * sizeof(int64_t));
+    for (int i = start; i < inc->n; i++) inc_push_row(inc, i);
+    return 0;
+}
+
+int knapsack_inc_count(const KnapsackIncremental* inc) {
+    return inc ? inc->n : 0;
+}
+
+const Item* knapsack_inc_items(const KnapsackIncremental* inc) {
+    return inc ? inc->items : NULL;
+}
+
+// 容量超出范围时按最大容量处理
+static int inc_capacity(const KnapsackIncremental* inc, double capacity) {
+    int c = (int)(capacity * 100 + 0.5);
+    if (c > inc->cap) c = inc->cap;
+    return c < 0 ? -1 : c;
+}
+
+double knapsack_inc_value(const KnapsackIncremental* inc, double capacity) {
+    if (!inc) return 0;
+    int c = inc_capacity(inc, capacity);
+    return c < 0 ? 0 : inc->last[c] / 100.0;
+}
+
+int knapsack_inc_select(const KnapsackIncremental* inc, double capacity, int* selected) {
+    if (!inc || !selected) return -1;
+    int w = inc_capacity(inc, capacity);
+    if (w < 0) return -1;
+    for (int i = inc->n - 1; i >= 0; i--) {
+        selected[i] = (int)((inc->keep[(size_t)i * inc->words + (w >> 6)] >> (w & 63)) & 1);
+        if (selected[i]) w -= inc->weights[i];
+    }
+    return 0;
+}
+// ---------------- 多容量查询 ----------------
+// 对最大容量 W 求解一次，最后一行即容量 0..W 的最优值（行单调不减），之后每个容量的查询 O(1)。
+// 选择方案只在被请求时重建：位图不超过 DP_BITSET_LIMIT 时求解时就记下整张位图，重建 O(n)；
+// 否则每 sqrt(n) 个物品保存一行检查点，重建时从后往前逐块重算该块的位图并回溯，
+// 一次请求的多个容量共用同一遍重算，代价约为一次求解。检查点总量与一块的位图都不超过 DP_BITSET_LIMIT
+// （块数按这两个限制在 sqrt(n) 附近调整）；两个限制无法同时满足时不存检查点，每个容量各用一次分治（Hirschberg）重建
+struct KnapsackCapacityTable {
+    int n;
+    int cap;               // 整数化的最大容量
+    size_t words;          // 每行位图的字数
+    DpIntEngine engine;
+    int* weights;
+    int64_t* values;
+    char* rows;            // 两行缓冲区
+    char* last;            // 最后一行，指向 rows 中的一行
+    uint64_t* keep;        // 整张位图（放得下时），否则为 NULL
+    char* checkpoints;     // 没有整张位图时，第 b 块之前的行
+    int block;             // 每块物品数，0 表示既没有位图也没有检查点（分治重建）
+};
+
+void knapsack_table_destroy(KnapsackCapacityTable* table) {
+    if (!table) return;
+    free(table->weights);
+    free(table->values);
+    free(table->rows);
+    free(table->keep);
+    free(table->checkpoints);
+    free(table);
+}
+
+KnapsackCapacityTable* knapsack_table_build(const Item* items, int n, double max_capacity) {
+    int cap = (int)(max_capacity * 100 + 0.5);
+    if (n < 0 || cap < 0) return NULL;
+    KnapsackCapacityTable* t = (KnapsackCapacityTable*)calloc(1, sizeof(KnapsackCapacityTable));
+    if (!t) return NULL;
+    t->n = n;
+    t->cap = cap;
+    t->words = ((size_t)cap + 64) / 64;
+    t->weights = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    t->values = (int64_t*)malloc((n > 0 ? n : 1) * sizeof(int64_t));
+    if (!t->weights || !t->values) {
+        knapsack_table_destroy(t);
+        return NULL;
+    }
+    int64_t total = 0;
+    for (int i = 0; i < n; i++) {
+        double v = items[i].value * 100;
+        t->weights[i] = (int)(items[i].weight * 100 + 0.5);
+        t->values[i] = v > 0 ? (int64_t)(v + 0.5) : 0;
+        total += t->values[i];
+    }
+    dpi_engine_init(&t->engine, total <= INT32_MAX ? 32 : 64);
+    size_t row_bytes = ((size_t)cap + 1) * t->engine.elem;
+    t->rows = (char*)malloc(2 * row_bytes);
+    if (!t->rows) {
+        knapsack_table_destroy(t);
+        return NULL;
+    }
+
+    size_t keep_bytes = (size_t)n * t->words * sizeof(uint64_t);
+    if (keep_bytes <= DP_BITSET_LIMIT) {
+        t->keep = (uint64_t*)calloc(keep_bytes > 0 ? keep_bytes : 1, 1);
+        if (!t->keep) {
+            knapsack_table_destroy(t);
+            return NULL;
+        }
+        t->last = dpi_fill_rows(&t->engine, t->weights, t->values, n, cap, t->rows, t->rows + row_bytes, t->keep,
+                                t->words);
+        return t;
+    }
+
+    // 块数取 ceil(sqrt(n))，再受两个限制：检查点共 blocks 行，一块的位图为 ceil(n/blocks) 行
+    long long blocks = 1;
+    while (blocks * blocks < n) blocks++;
+    long long max_blocks = (long long)(DP_BITSET_LIMIT / row_bytes);
+    long long min_blocks = (long long)((keep_bytes + DP_BITSET_LIMIT - 1) / DP_BITSET_LIMIT);
+    if (blocks > max_blocks) blocks = max_blocks;
+    if (blocks < min_blocks) blocks = min_blocks;
+    if (blocks <= max_blocks) {
+        t->block = (int)((n + blocks - 1) / blocks);
+        blocks = (n + t->block - 1) / t->block;
+        t->checkpoints = (char*)malloc((size_t)blocks * row_bytes);
+        if (!t->checkpoints) {
+            knapsack_table_destroy(t);
+            return NULL;
+        }
+    }
+    char* prev = t->rows;
+    char* cur = t->rows + row_bytes;
+    memset(prev, 0, row_bytes);
+    for (int i = 0; i < n; i++) {
+        if (t->block && i % t->block == 0) {
+            memcpy(t->checkpoints + (size_t)(i / t->block) * row_bytes, prev, row_bytes);
+        }
+        dpi_row_update(&t->engine, prev, cur, cap, t->weights[i], t->values[i], NULL);
+        char* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+    t->last = prev;
+    return t;
+}
+
+// 容量超出范围时按最大容量处理，负数返回 -1
+static int table_capacity(const KnapsackCapacityTable* t, double capacity) {
+    int c = (int)(capacity * 100 + 0.5);
+    if (c > t->cap) c = t->cap;
+    return c < 0 ? -1 : c;
+}
+
+double knapsack_table_value(const KnapsackCapacityTable* table, double capacity) {
+    if (!table) return 0;
+    int c = table_capacity(table, capacity);
+    return c < 0 ? 0 : dpi_get(&table->engine, table->last, c) / 100.0;
+}
+
+void knapsack_table_values(const KnapsackCapacityTable* table, const double* capacities, int count, double* out) {
+    for (int k = 0; k < count; k++) out[k] = knapsack_table_value(table, capacities[k]);
+}
+
+int knapsack_table_select(KnapsackCapacityTable* table, const double* capacities, int count, int** selected) {
+    if (!table || count < 0) return -1;
+    int* w = (int*)scratch_malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!w) return -1;
+    for (int k = 0; k < count; k++) {
+        w[k] = table_capacity(table, capacities[k]);
+        if (w[k] < 0) {
+            scratch_free(w);
+            return -1;
+        }
+    }
+    int status = 0;
+    if (table->keep) {
+        for (int k = 0; k < count; k++) {
+            for (int i = table->n - 1; i >= 0; i--) {
+                selected[k][i] = (int)((table->keep[(size_t)i * table->words + (w[k] >> 6)] >> (w[k] & 63)) & 1);
+                if (selected[k][i]) w[k] -= table->weights[i];
+            }
+        }
+    } else if (!table->block) {
+        // 没有检查点：每个容量从头做一次分治重建
+        size_t row_bytes = ((size_t)table->cap + 1) * table->engine.elem;
+        DpiHsContext hs;
+        hs.e = &table->engine;
+        hs.weight = table->weights;
+        hs.value = table->values;
+        hs.f = (char*)scratch_malloc(row_bytes);
+        hs.f_tmp = (char*)scratch_malloc(row_bytes);
+        hs.g = (char*)scratch_malloc(row_bytes);
+        hs.g_tmp = (char*)scratch_malloc(row_bytes);
+        hs.keep = (uint64_t*)scratch_malloc(DP_HS_BASE_ITEMS * table->words * sizeof(uint64_t));
+        if (hs.f && hs.f_tmp && hs.g && hs.g_tmp && hs.keep) {
+            for (int k = 0; k < count; k++) {
+                hs.selected = selected[k];
+                dpi_hirschberg(&hs, 0, table->n, w[k]);
+            }
+        } else {
+            status = -1;
+        }
+        scratch_free(hs.f);
+        scratch_free(hs.f_tmp);
+        scratch_free(hs.g);
+        scratch_free(hs.g_tmp);
+        scratch_free(hs.keep);
+    } else {
+        // 从最后一块往前，从检查点重算该块的位图，各容量在块内回溯
+        size_t row_bytes = ((size_t)table->cap + 1) * table->engine.elem;
+        uint64_t* keep = (uint64_t*)scratch_malloc((size_t)table->block * table->words * sizeof(uint64_t));
+        char* row_a = (char*)scratch_malloc(row_bytes);
+        char* row_b = (char*)scratch_malloc(row_bytes);
+        if (keep && row_a && row_b) {
+            int blocks = (table->n + table->block - 1) / table->block;
+            for (int b = blocks - 1; b >= 0; b--) {
+                int lo = b * table->block;
+                int hi = lo + table->block < table->n ? lo + table->block : table->n;
+                char* prev = row_a;
+                char* cur = row_b;
+                memcpy(prev, table->checkpoints + (size_t)b * row_bytes, row_bytes);
+                memset(keep, 0, (size_t)(hi - lo) * table->words * sizeof(uint64_t));
+                for (int i = lo; i < hi; i++) {
+                    dpi_row_update(&table->engine, prev, cur, table->cap, table->weights[i], table->values[i],
+                                   keep + (size_t)(i - lo) * table->words);
+                    char* tmp = prev;
+                    prev = cur;
+                    cur = tmp;
+                }
+                for (int k = 0; k < count; k++) {
+                    for (int i = hi - 1; i >= lo; i--) {
+                        const uint64_t* row = keep + (size_t)(i - lo) * table->words;
+                        selected[k][i] = (int)((row[w[k] >> 6] >> (w[k] & 63)) & 1);
+                        if (selected[k][i]) w[k] -= table->weights[i];
+                    }
+                }
+            }
+        } else {
+            status = -1;
+        }
+        scratch_free(keep);
+        scratch_free(row_a);
+        scratch_free(row_b);
+    }
+    scratch_free(w);
+    return status;
+}
@@ -0,0 +1,309 @@
+#ifndef KNAPSACK_H
+#define KNAPSACK_H
+
+// 0-1 背包求解库：各算法的公共接口
+// 静态库/动态库的编译方法见 README.md
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 动态库导出符号（Windows 下编译 DLL 时定义 KNAPSACK_BUILD_DLL，使用 DLL 时定义 KNAPSACK_USE_DLL）
+#if defined(_WIN32) && defined(KNAPSACK_BUILD_DLL)
+#define KNAPSACK_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(KNAPSACK_USE_DLL)
+#define KNAPSACK_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define KNAPSACK_API __attribute__((visibility("default")))
+#else
+#define KNAPSACK_API
+#endif
+
+// 线程局部变量：统计信息与当前内存池按线程区分，多个线程可同时求解
+#if defined(_MSC_VER)
+#define KS_THREAD_LOCAL __declspec(thread)
+#else
+#define KS_THREAD_LOCAL __thread
+#endif
+
+// 物品结构体
+typedef struct {
+    int id;        // 物品编号
+    double weight; // 物品重量
+    double value;  // 物品价值
+} Item;
+
+// CPU 核数，作为多线程算法的默认线程数
+KNAPSACK_API int cpu_count(void);
+
+// 单调时钟（纳秒），用于计时；与系统时间无关，不受对时影响
+KNAPSACK_API uint64_t knapsack_now_ns(void);
+
+// 临时内存：求解器内部统一通过 scratch_* 分配，便于统计峰值内存；
+// 在 knapsack_solve 内部调用时从上下文的内存池中分配
+KNAPSACK_API void* scratch_malloc(size_t size);
+KNAPSACK_API void* scratch_calloc(size_t count, size_t size);
+KNAPSACK_API void scratch_free(void* ptr);
+KNAPSACK_API void mem_reset_peak(void); // 把峰值重置为当前用量，在每次计时前调用
+KNAPSACK_API size_t mem_peak_bytes(void);
+
+// 硬件性能计数器：用 Linux perf_event_open 按求解阶段分别累计周期、指令、缓存未命中、分支未命中，
+// 用来判断 DP 填表受限于访存还是计算。默认关闭，按线程开启；计数器打不开时对应字段为 -1，阶段耗时照常统计
+typedef enum {
+    KS_PHASE_DP_SETUP,       // dynamic_programming：整数化与分配表
+    KS_PHASE_DP_FILL,        // dynamic_programming：填表
+    KS_PHASE_DP_RECONSTRUCT, // dynamic_programming：回溯选中物品并释放表
+    KS_PHASE_GREEDY_SORT,    // greedy：按单位价值排序
+    KS_PHASE_GREEDY_FILL,    // greedy：依次装入
+    KS_PHASE_COUNT
+} KnapsackPhase;
+
+typedef struct {
+    long long cycles;        // CPU 周期，不可用时为 -1
+    long long instructions;  // 指令数
+    long long cache_misses;  // 末级缓存未命中
+    long long branch_misses; // 分支预测失败
+    long long ns;            // 阶段耗时（纳秒）
+    long long calls;         // 累计的次数
+} KnapsackPerfCounters;
+
+// 对调用线程开启（on 非 0）或关闭计数，返回打开成功的硬件计数器个数（0 表示只统计耗时）
+KNAPSACK_API int knapsack_perf_enable(int on);
+KNAPSACK_API void knapsack_perf_reset(void); // 清零各阶段的累计值
+KNAPSACK_API void knapsack_perf_read(KnapsackPhase phase, KnapsackPerfCounters* out);
+KNAPSACK_API const char* knapsack_perf_phase_name(KnapsackPhase phase);
+
+// 各算法：selected 长度为 n，求解后 selected[i] 为 1 表示选中第 i 个物品
+KNAPSACK_API void brute_force(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void meet_in_middle(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void brute_force_gray(Item* items, int n, double capacity, int* selected, double* max_value, int threads);
+KNAPSACK_API void backtrack(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
+                            double* max_value, int* curr_selected, int* best_selected);
+KNAPSACK_API void backtrack_prune(Item* items, int n, double capacity, int idx, double curr_weight, double curr_value,
+                                  double* max_value, int* curr_selected, int* best_selected, double remain_value);
+KNAPSACK_API void backtrack_iterative(Item* items, int n, double capacity, int* selected, double* max_value, int prune);
+KNAPSACK_API void dynamic_programming(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void dynamic_programming_parallel(Item* items, int n, double capacity, int* selected, double* max_value, int threads);
+KNAPSACK_API void dynamic_programming_rolling(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void dynamic_programming_int(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void sparse_dp(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void greedy(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void greedy_selection(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void greedy_fast(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void core_solver(Item* items, int n, double capacity, int* selected, double* max_value);
+KNAPSACK_API void branch_and_bound(Item* items, int n, double capacity, int* selected, double* max_value, int best_first);
+
+// 限时求解：在 deadline_ms 毫秒内先给出贪心解，再用局部搜索和逐轮扩大的核DP改进，同时收紧上界；
+// 到时返回当前最好的解和已证明的最优性差距（重量按 ×100 取整，与 DP 的模型一致）
+typedef struct {
+    double lower;      // 返回解的价值
+    double upper;      // 已证明的上界：最优值不超过它
+    double gap;        // (upper - lower) / upper，0 表示已证明最优
+    int core_size;     // 最后完成的核DP的物品数，0 表示没来得及做核DP
+    int iterations;    // 完成的核DP轮数
+    double elapsed_ms; // 实际耗时
+} KnapsackAnytimeStats;
+
+KNAPSACK_API void knapsack_anytime(Item* items, int n, double capacity, double deadline_ms, int* selected,
+                                   double* max_value, KnapsackAnytimeStats* stats);
+
+KNAPSACK_API int cmp(const void* a, const void* b); // 按单位价值降序
+KNAPSACK_API void selection_sort(Item* items, int n);
+
+// DP 内核选择：-1 自动检测，0 标量，1 SSE2，2 AVX，3 AVX2（整数DP使用 AVX2 整数内核）
+KNAPSACK_API void dp_set_simd(int level);
+KNAPSACK_API const char* dp_simd_name(void);
+// DP 时间分块：-1 自动（两行超过 4MB 时启用），0 关闭，k>0 强制启用且每次最多推进 k 个物品
+KNAPSACK_API void dp_set_blocking(int items);
+
+// 最近一次求解的状态（每个线程各自一份）：库函数不向 stdout 输出提示，出错或只用了部分物品时记在这里，
+// 由调用者决定如何提示。knapsack_solve 在 KS_STATUS_NO_MEMORY / KS_STATUS_TOO_MANY_STATES 时返回 -1
+typedef enum {
+    KS_STATUS_OK = 0,
+    KS_STATUS_NO_MEMORY,       // 内存不足，没有求出解
+    KS_STATUS_TOO_MANY_STATES, // 稀疏DP状态数超过上限
+    KS_STATUS_TRUNCATED        // 物品数超过算法上限（MITM_MAX_ITEMS / BF_GRAY_MAX_ITEMS），只用了前面的物品
+} KnapsackStatus;
+
+#define MITM_MAX_ITEMS 50    // 折半搜索最多支持的物品数（后一半最多 2^25 个子集）
+#define BF_GRAY_MAX_ITEMS 40 // 格雷码蛮力法最多支持的物品数
+
+extern KS_THREAD_LOCAL KNAPSACK_API int knapsack_last_status; // KnapsackStatus
+KNAPSACK_API const char* knapsack_status_message(int status);
+
+// 最近一次求解的统计信息（每个线程各自一份）
+extern KS_THREAD_LOCAL KNAPSACK_API long long sparse_last_states; // 稀疏DP累计保留的状态数
+extern KS_THREAD_LOCAL KNAPSACK_API int sparse_last_max_list;     // 稀疏DP单层表的最大长度
+extern KS_THREAD_LOCAL KNAPSACK_API int core_last_size;           // 核算法最终使用的核大小
+extern KS_THREAD_LOCAL KNAPSACK_API long long bb_last_nodes;      // 分支限界扩展的结点数
+extern KS_THREAD_LOCAL KNAPSACK_API int dp_int_last_bits;         // 整数DP使用的元素位数（32 或 64）
+
+// 求解器上下文：持有一块预先分配的内存池和物品副本，多次求解之间复用，
+// 热路径上不再调用 malloc/free。一个上下文同一时间只能被一个线程使用。
+typedef struct KnapsackContext KnapsackContext;
+
+typedef enum {
+    KS_BRUTE_FORCE = 1,     // 蛮力法（n <= 30）
+    KS_BACKTRACK,           // 回溯法（迭代剪枝版）
+    KS_DP,                  // 动态规划法
+    KS_GREEDY,              // 贪心法（快排）
+    KS_DP_ROLLING,          // 滚动数组动态规划
+    KS_DP_PARALLEL,         // 多线程动态规划
+    KS_BB_DFS,              // 分支限界法（深度优先）
+    KS_BB_BEST_FIRST,       // 分支限界法（最佳优先）
+    KS_MEET_IN_MIDDLE,      // 折半搜索（n <= 50）
+    KS_BRUTE_FORCE_GRAY,    // 格雷码多线程蛮力法（n <= 40）
+    KS_GREEDY_FAST,         // 贪心法（快速选择版）
+    KS_CORE,                // 核心算法
+    KS_SPARSE_DP,           // 稀疏动态规划
+    KS_DP_INT               // 整数定点动态规划
+} KnapsackAlgo;
+
+// 创建上下文，arena_bytes 为内存池初始大小（可为 0，首次求解后按实际用量扩容）
+KNAPSACK_API KnapsackContext* knapsack_context_create(size_t arena_bytes);
+KNAPSACK_API void knapsack_context_destroy(KnapsackContext* ctx);
+// 多线程算法使用的线程数，默认 cpu_count()
+KNAPSACK_API void knapsack_context_set_threads(KnapsackContext* ctx, int threads);
+// 内存池当前大小与历史最高用量（字节）
+KNAPSACK_API size_t knapsack_context_arena_size(const KnapsackContext* ctx);
+KNAPSACK_API size_t knapsack_context_high_water(const KnapsackContext* ctx);
+
+// 用指定算法求解，items 不会被修改；成功返回 0，参数非法或内存不足返回 -1
+KNAPSACK_API int knapsack_solve(KnapsackContext* ctx, KnapsackAlgo algo, const Item* items, int n,
+                                double capacity, int* selected, double* max_value);
+
+// 批量求解统计
+typedef struct {
+    long long instances; // 实例数
+    long long failed;    // 求解失败的实例数
+    double seconds;      // 墙钟时间（秒）
+    double per_second;   // 每秒求解的实例数
+    double p50_us;       // 单个实例求解延迟的中位数（微秒）
+    double p99_us;       // 单个实例求解延迟的 99 分位数（微秒）
+    int in_flight;       // 同时在途的实例数上限
+} KnapsackBatchStats;
+
+// 按实例规模选择算法：物品少时用稀疏DP，整数化容量较小时用滚动DP，其余用核心算法
+KNAPSACK_API KnapsackAlgo knapsack_pick_algo(int n, double capacity);
+
+// 批量求解：从 in 依次读入实例（"n 容量" 后跟 n 行 "重量 价值"），用 threads 个工作线程求解，
+// 按输入顺序向 out 输出 "最优价值 选中个数 选中物品编号..."（编号从 1 开始，失败输出 -1）。
+// threads <= 0 时使用 cpu_count()；stats 可为 NULL。成功返回 0，无法启动（内存不足）返回 -1；
+// 某个实例格式错误、不完整或读入时内存不足时输出之前的结果后停止，返回 1（stats->instances 为已求解的实例数）
+KNAPSACK_API int knapsack_batch_solve(FILE* in, FILE* out, int threads, KnapsackBatchStats* stats);
+
+// 读取 CSV 的统计
+typedef struct {
+    long long rows;    // 读入的物品数
+    long long skipped; // 格式错误而跳过的行数
+    size_t bytes;      // 读取的字节数
+    double seconds;    // 墙钟时间（秒）
+    double mb_per_s;   // 读取速度（MB/s）
+} KnapsackLoadStats;
+
+// 读取整个 CSV 文件（"编号,重量,价值"，表头可有可无），文件用 mmap 映射后多线程解析。
+// 返回的数组用 free 释放，物品数写入 *count；threads <= 0 时使用 cpu_count()；失败返回 NULL
+KNAPSACK_API Item* knapsack_load_csv(const char* path, int threads, int* count, KnapsackLoadStats* stats);
+
+// 流式读取：每次读入约 chunk_bytes 字节（0 表示默认 64MB），解析出的物品交给 sink；
+// items 只在回调期间有效，sink 返回非 0 时提前结束。用于比内存还大的文件，返回物品总数，失败返回 -1
+typedef int (*KnapsackItemSink)(const Item* items, int count, void* user);
+KNAPSACK_API long long knapsack_stream_csv(const char* path, size_t chunk_bytes, int threads, KnapsackItemSink sink,
+                                           void* user, KnapsackLoadStats* stats);
+
+// 列式二进制实例文件：编号、重量、价值各占一列，可选附带 ×100 取整后的 int32 重量列（与 DP 的整数化一致）。
+// 打开时整个文件 mmap，列指针直接指向映射区，不解析也不复制
+#define KNAPSACK_BIN_INT_WEIGHT 1 // 写入整数重量列
+
+typedef struct {
+    int n;                      // 物品数
+    double capacity;            // 文件中记录的背包容量
+    int scale;                  // 整数重量列的放大倍数
+    const int32_t* id;          // 物品编号
+    const double* weight;
+    const double* value;
+    const int32_t* int_weight;  // 整数重量列，没有时为 NULL
+    void* map;                  // 内部使用
+} KnapsackColumns;
+
+// 把 Item 数组写成二进制实例文件，flags 为 0 或 KNAPSACK_BIN_INT_WEIGHT；成功返回 0
+KNAPSACK_API int knapsack_save_binary(const char* path, const Item* items, int n, double capacity, int flags);
+// 把 CSV 文件流式转换为二进制实例文件（CSV 读两遍，不需要整个装入内存）；成功返回 0
+KNAPSACK_API int knapsack_convert_csv(const char* csv_path, const char* bin_path, double capacity, int flags,
+                                      KnapsackLoadStats* stats);
+// 映射二进制实例文件，版本或字节序不符、列超出文件或互相重叠时失败；成功返回 0，用完调用 knapsack_close_binary
+KNAPSACK_API int knapsack_open_binary(const char* path, KnapsackColumns* cols);
+KNAPSACK_API void knapsack_close_binary(KnapsackColumns* cols);
+
+// 列式求解：与对应的 Item 版本结果相同，selected 长度为 cols->n
+KNAPSACK_API void greedy_fast_columns(const KnapsackColumns* cols, double capacity, int* selected, double* max_value);
+KNAPSACK_API void core_solver_columns(const KnapsackColumns* cols, double capacity, int* selected, double* max_value);
+KNAPSACK_API void dynamic_programming_columns(const KnapsackColumns* cols, double capacity, int* selected,
+                                              double* max_value, int threads);
+
+// 增量求解：物品逐个加入或删除时维护 DP 表，不必每次从头求解。
+// 加入一个物品 O(W)；任意容量 W' <= W 的最优值 O(1) 查表，选择方案 O(n) 重建；
+// 删除第 p 个物品时从 p 之前最近的检查点重放后面的物品，删除越靠后的物品越快。
+// 内存约为 n*W/8（选择位图）+ n*W/8（每 64 行一个 int64 检查点）字节，一个状态同一时间只能被一个线程使用
+typedef struct KnapsackIncremental KnapsackIncremental;
+
+KNAPSACK_API KnapsackIncremental* knapsack_inc_create(double max_capacity); // 失败返回 NULL
+KNAPSACK_API void knapsack_inc_destroy(KnapsackIncremental* inc);
+KNAPSACK_API int knapsack_inc_add(KnapsackIncremental* inc, const Item* item); // 成功返回 0
+KNAPSACK_API int knapsack_inc_remove(KnapsackIncremental* inc, int id);        // 删除编号为 id 的物品，没有返回 -1
+KNAPSACK_API int knapsack_inc_count(const KnapsackIncremental* inc);
+KNAPSACK_API const Item* knapsack_inc_items(const KnapsackIncremental* inc);   // 按加入顺序，删除后后面的物品前移
+// 容量 capacity（超过最大容量时按最大容量）下的最优值
+KNAPSACK_API double knapsack_inc_value(const KnapsackIncremental* inc, double capacity);
+// 重建该容量下的选择，selected 长度为 knapsack_inc_count()，与 knapsack_inc_items() 的顺序对应；成功返回 0
+KNAPSACK_API int knapsack_inc_select(const KnapsackIncremental* inc, double capacity, int* selected);
+
+// 多容量查询：对最大容量求解一次，之后任意容量（不超过最大容量）的最优值 O(1) 查表；
+// 选择方案只对请求的容量重建（位图放得下时每个容量 O(n)，否则一次请求的所有容量共用一遍约等于求解的重算）
+typedef struct KnapsackCapacityTable KnapsackCapacityTable;
+
+KNAPSACK_API KnapsackCapacityTable* knapsack_table_build(const Item* items, int n, double max_capacity); // 失败返回 NULL
+KNAPSACK_API void knapsack_table_destroy(KnapsackCapacityTable* table);
+KNAPSACK_API double knapsack_table_value(const KnapsackCapacityTable* table, double capacity);
+KNAPSACK_API void knapsack_table_values(const KnapsackCapacityTable* table, const double* capacities, int count,
+                                        double* out);
+// 重建 count 个容量下的选择，selected[k] 长度为 n；成功返回 0
+KNAPSACK_API int knapsack_table_select(KnapsackCapacityTable* table, const double* capacities, int count,
+                                       int** selected);
+
+// 实例生成：Pisinger 的经典难例分类（不相关类之外的数据以 0.01 为单位、范围 R = 100.00）。
+// 相关性越强，贪心与上界越接近但精确解越难找；不相关类与原 generate_items 的范围相同，是最容易的一类
+typedef enum {
+    KS_GEN_UNCORRELATED = 0,    // 不相关：重量 1.00~100.00，价值 100.00~1000.00
+    KS_GEN_WEAKLY_CORRELATED,   // 弱相关：价值在重量 ±R/10 内
+    KS_GEN_STRONGLY_CORRELATED, // 强相关：价值 = 重量 + R/10
+    KS_GEN_INVERSE_STRONGLY,    // 反强相关：重量 = 价值 + R/10
+    KS_GEN_SUBSET_SUM,          // 子集和：价值 = 重量
+    KS_GEN_SIMILAR_WEIGHTS,     // 相近重量：重量 99.00~100.00，价值 0.01~10.00
+    KS_GEN_SPANNER,             // 张成：由 2 个强相关物品乘以 1~10 倍得到
+    KS_GEN_CLASS_COUNT
+} KnapsackInstanceClass;
+
+// 随机数发生器（xoshiro256**），比 rand() 快且周期长，每个线程各用一个
+typedef struct {
+    uint64_t s[4];
+} KnapsackRng;
+
+KNAPSACK_API void knapsack_rng_seed(KnapsackRng* rng, uint64_t seed);
+KNAPSACK_API uint64_t knapsack_rng_next(KnapsackRng* rng);
+KNAPSACK_API int64_t knapsack_rng_range(KnapsackRng* rng, int64_t lo, int64_t hi); // [lo, hi] 上的均匀整数
+KNAPSACK_API const char* knapsack_gen_class_name(KnapsackInstanceClass cls);
+
+// 生成 n 个物品（编号 1~n）。相同 seed 的结果相同，与 threads 无关；threads <= 0 时使用 cpu_count()。
+// 成功返回 0，参数非法返回 -1
+KNAPSACK_API int knapsack_generate(Item* items, int n, KnapsackInstanceClass cls, uint64_t seed, int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif